@@ -16,7 +16,12 @@
 
    // C/C++:
    #include <iostream>
+   #include <algorithm>
    #include <chrono>
+   #include <cmath>
+   #include <functional>
+   #include <limits>
+   #include <string>
 
 
 
@@ -40,6 +45,11 @@
    // Tire reference:
    std::reference_wrapper<Eng::Mesh> tire = Eng::Mesh::empty;
 
+   // Animated meshes:
+   std::reference_wrapper<Eng::Mesh> hose = Eng::Mesh::empty;
+   std::reference_wrapper<Eng::Mesh> hedra = Eng::Mesh::empty;
+   std::reference_wrapper<Eng::Mesh> chamfer = Eng::Mesh::empty;
+
    // Pipelines:
    Eng::PipelineDefault dfltPipe;
    Eng::PipelineFullscreen2D full2dPipe;
@@ -157,6 +167,294 @@ void keyboardCallback(int key, int scancode, int action, int mods)
 
 
 
+////////////////
+// BENCHMARKS //
+////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Runs a function a few times and keeps the best timing.
+ * @param func function to time
+ * @return best time in milliseconds
+ */
+double timeBest(const std::function<void()> &func)
+{
+   std::chrono::high_resolution_clock timer;
+   double best = std::numeric_limits<double>::max();
+   for (uint32_t c = 0; c < 5; c++)
+   {
+      auto start = timer.now();
+      func();
+      auto stop = timer.now();
+      best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+   }
+   return best;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializer benchmark: reads a mapped OVO file as a stream of values through deserialize() and through the typed 
+ * read<T>()/readSpan<T>() fast path, and prints the throughput of each.
+ * @param filename OVO file
+ * @return TF
+ */
+bool benchSerializer(const std::string &filename)
+{
+   Eng::Serializer serial;
+   if (!serial.map(filename) || serial.getNrOfBytes() < sizeof(Eng::Vbo::VertexData))
+   {
+      std::cout << "Unable to open file '" << filename << "'" << std::endl;
+      return false;
+   }
+
+   // Read the file several times, so that each test covers at least 256 MB:
+   const uint64_t nrOfBytes = serial.getNrOfBytes();
+   const uint64_t nrOfWords = nrOfBytes / sizeof(uint32_t);
+   const uint64_t nrOfVertices = nrOfBytes / sizeof(Eng::Vbo::VertexData);
+   const uint64_t nrOfPasses = std::max(static_cast<uint64_t>(256 * 1024 * 1024) / nrOfBytes, static_cast<uint64_t>(1));
+   std::vector<uint32_t> words(nrOfWords);
+   uint64_t checksum = 0;
+
+   auto report = [nrOfPasses](const char *name, uint64_t bytes, double ms)
+   {
+      const double mbs = (static_cast<double>(bytes * nrOfPasses) / (1024.0 * 1024.0)) / (ms / 1000.0);
+      std::cout << "   " << name << ": " << mbs << " MB/s" << std::endl;
+   };
+
+   std::cout << "Serializer, " << nrOfBytes << " bytes x " << nrOfPasses << " passes:" << std::endl;
+
+   // Single values:
+   report("deserialize(uint32_t &)", nrOfWords * sizeof(uint32_t), timeBest([&]()
+   {
+      for (uint64_t p = 0; p < nrOfPasses; p++)
+      {
+         serial.setPosition(0);
+         uint32_t value;
+         for (uint64_t c = 0; c < nrOfWords; c++)
+            if (serial.deserialize(value))
+               checksum += value;
+      }
+   }));
+   report("read<uint32_t>()", nrOfWords * sizeof(uint32_t), timeBest([&]()
+   {
+      for (uint64_t p = 0; p < nrOfPasses; p++)
+      {
+         serial.setPosition(0);
+         uint32_t value;
+         for (uint64_t c = 0; c < nrOfWords; c++)
+            if (serial.read(value))
+               checksum += value;
+      }
+   }));
+
+   // Vertex records:
+   report("deserialize(), vertex field by field", nrOfVertices * sizeof(Eng::Vbo::VertexData), timeBest([&]()
+   {
+      for (uint64_t p = 0; p < nrOfPasses; p++)
+      {
+         serial.setPosition(0);
+         Eng::Vbo::VertexData vertex;
+         for (uint64_t c = 0; c < nrOfVertices; c++)
+            if (serial.deserialize(vertex.vertex) && serial.deserialize(vertex.normal) && 
+                serial.deserialize(vertex.uv) && serial.deserialize(vertex.tangent))
+               checksum += vertex.normal;
+      }
+   }));
+   report("read<Vbo::VertexData>()", nrOfVertices * sizeof(Eng::Vbo::VertexData), timeBest([&]()
+   {
+      for (uint64_t p = 0; p < nrOfPasses; p++)
+      {
+         serial.setPosition(0);
+         Eng::Vbo::VertexData vertex;
+         for (uint64_t c = 0; c < nrOfVertices; c++)
+            if (serial.read(vertex))
+               checksum += vertex.normal;
+      }
+   }));
+
+   // Arrays:
+   report("deserialize(void *, size)", nrOfWords * sizeof(uint32_t), timeBest([&]()
+   {
+      for (uint64_t p = 0; p < nrOfPasses; p++)
+      {
+         serial.setPosition(0);
+         if (serial.deserialize(words.data(), nrOfWords * sizeof(uint32_t)))
+            checksum += words.back();
+      }
+   }));
+   report("readSpan<uint32_t>(values, count)", nrOfWords * sizeof(uint32_t), timeBest([&]()
+   {
+      for (uint64_t p = 0; p < nrOfPasses; p++)
+      {
+         serial.setPosition(0);
+         if (serial.readSpan(words.data(), nrOfWords))
+            checksum += words.back();
+      }
+   }));
+
+   // Done:
+   std::cout << "   (checksum: " << checksum << ")" << std::endl;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Math benchmark: runs the batch kernels with each supported instruction set against the scalar GLM loop and prints
+ * the timings, the speedups, and the largest difference from the GLM results.
+ * @return TF
+ */
+bool benchMath()
+{
+   // Random-ish affine matrices (small enough to stay in cache, so that the kernels and not the memory are timed):
+   const uint64_t nrOfMatrices = 4096;
+   const uint64_t nrOfPasses = 100;
+   std::vector<glm::mat4> matrices(nrOfMatrices);
+   for (uint64_t c = 0; c < nrOfMatrices; c++)
+   {
+      const float f = static_cast<float>(c);
+      matrices[c] = glm::translate(glm::mat4(1.0f), glm::vec3(f, -f * 0.5f, f * 0.25f));
+      matrices[c] = glm::rotate(matrices[c], f * 0.01f, glm::normalize(glm::vec3(1.0f, f, 2.0f)));
+      matrices[c] = glm::scale(matrices[c], glm::vec3(1.0f + (c % 7), 1.0f + (c % 3), 0.5f + (c % 5)));
+   }
+   const glm::mat4 left = glm::perspective(glm::radians(45.0f), 1.5f, 0.1f, 1000.0f) *
+                          glm::lookAt(glm::vec3(10.0f, 20.0f, 30.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+   std::vector<glm::mat4> expected(nrOfMatrices), expectedNormal(nrOfMatrices), result(nrOfMatrices);
+
+   auto maxError = [&](const std::vector<glm::mat4> &reference)
+   {
+      float error = 0.0f;
+      for (uint64_t c = 0; c < nrOfMatrices; c++)
+         for (uint32_t i = 0; i < 4; i++)
+            for (uint32_t j = 0; j < 4; j++)
+               error = std::max(error, std::abs(result[c][i][j] - reference[c][i][j]) / std::max(1.0f, std::abs(reference[c][i][j])));
+      return error;
+   };
+
+   std::cout << "Math, " << nrOfMatrices << " matrices x " << nrOfPasses << " passes:" << std::endl;
+
+   // Scalar reference:
+   const double glmMultiply = timeBest([&]()
+   {
+      for (uint64_t p = 0; p < nrOfPasses; p++)
+         for (uint64_t c = 0; c < nrOfMatrices; c++)
+            expected[c] = left * matrices[c];
+   });
+   const double glmNormal = timeBest([&]()
+   {
+      for (uint64_t p = 0; p < nrOfPasses; p++)
+         for (uint64_t c = 0; c < nrOfMatrices; c++)
+            expectedNormal[c] = glm::mat4(glm::inverseTranspose(glm::mat3(matrices[c])));
+   });
+   std::cout << "   glm: multiply " << glmMultiply << " ms, normal matrix " << glmNormal << " ms" << std::endl;
+
+   // Kernels, per instruction set:
+   static const char *simdNames[] = { "none", "sse2", "avx2" };
+   const Eng::Math::Simd supported = Eng::Math::getSupportedSimd();
+   for (uint32_t c = 0; c <= static_cast<uint32_t>(supported); c++)
+   {
+      if (!Eng::Math::setSimd(static_cast<Eng::Math::Simd>(c)))
+         return false;
+
+      const double multiply = timeBest([&]()
+      {
+         for (uint64_t p = 0; p < nrOfPasses; p++)
+            Eng::Math::multiply(left, matrices.data(), result.data(), nrOfMatrices);
+      });
+      const float multiplyError = maxError(expected);
+      const double normal = timeBest([&]()
+      {
+         for (uint64_t p = 0; p < nrOfPasses; p++)
+            Eng::Math::normalMatrix(matrices.data(), result.data(), nrOfMatrices);
+      });
+      const float normalError = maxError(expectedNormal);
+
+      std::cout << "   " << simdNames[c] << ": multiply " << multiply << " ms (x" << glmMultiply / multiply << ", err " << multiplyError
+                << "), normal matrix " << normal << " ms (x" << glmNormal / normal << ", err " << normalError << ")" << std::endl;
+   }
+
+   // Restore the default:
+   Eng::Math::setSimd(supported);
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Traversal benchmark: builds a synthetic tree of one million meshes (eight children per node) and times the render 
+ * list processing, an indexed walk through all the children, and the tree dump.
+ * @return TF
+ */
+bool benchTraversal()
+{
+   const uint32_t nrOfNodes = 1000000;
+   const uint32_t fanOut = 8;
+   std::vector<std::unique_ptr<Eng::Mesh>> nodes;
+   nodes.reserve(nrOfNodes);
+   nodes.push_back(std::make_unique<Eng::Mesh>());
+   for (uint32_t c = 1; c < nrOfNodes; c++)
+   {
+      nodes.push_back(std::make_unique<Eng::Mesh>());
+      if (!nodes[(c - 1) / fanOut]->addChild(*nodes[c]))
+         return false;
+   }
+
+   std::cout << "Traversal, " << nrOfNodes << " nodes (" << fanOut << " children per node):" << std::endl;
+
+   // Render list:
+   Eng::List list;
+   const double process = timeBest([&]()
+   {
+      list.reset();
+      list.process(*nodes[0]);
+   });
+   std::cout << "   List::process: " << process << " ms (" << list.getNrOfRenderableElems() << " elements)" << std::endl;
+
+   // Indexed access:
+   uint64_t checksum = 0;
+   const double children = timeBest([&]()
+   {
+      for (auto &n : nodes)
+         for (uint32_t c = 0; c < n->getNrOfChildren(); c++)
+            checksum += n->getChild(c).getId();
+   });
+   std::cout << "   getChild(): " << children << " ms (checksum: " << checksum << ")" << std::endl;
+
+   // Dump:
+   uint64_t length = 0;
+   const double dump = timeBest([&]()
+   {
+      length = nodes[0]->getTreeAsString().size();
+   });
+   std::cout << "   getTreeAsString(): " << dump << " ms (" << length << " chars)" << std::endl;
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Runs the CPU benchmarks (no window is opened).
+ * @param filename OVO file used by the benchmarks reading data
+ * @return error code (0 on success, error code otherwise)
+ */
+int runBenchmarks(const std::string &filename)
+{
+   if (!benchSerializer(filename))
+      return 1;
+   if (!benchMath())
+      return 1;
+   if (!benchTraversal())
+      return 1;
+
+   // Done:
+   return 0;
+}
+
+
+
 //////////
 // MAIN //
 //////////
@@ -173,6 +471,10 @@ int main(int argc, char *argv[])
    std::cout << "Engine demo, A. Peternier (C) SUPSI" << std::endl;
    std::cout << std::endl;
 
+   // Benchmark mode (usage: demo -bench [file.ovo]):
+   if (argc > 1 && std::string(argv[1]) == "-bench")
+      return runBenchmarks(argc > 2 ? argv[2] : "scene.ovo");
+
    // Init engine:
    Eng::Base &eng = Eng::Base::getInstance();
    eng.init();
@@ -186,38 +488,23 @@ int main(int argc, char *argv[])
    
 
    /////////////////
-   // Loading scene:   
+   // Loading scene (in background, attached progressively by the main loop):
    Eng::Ovo ovo;
-   //Eng::Node& root = ovo.load("simple3dScene.ovo");
-   Eng::Node &root = ovo.load("scene.ovo");
-   rootRef = root;
-   std::cout << "Scene graph:\n" << root.getTreeAsString() << std::endl;
-
-   // Get light ref:
-   light = dynamic_cast<Eng::Light&>(Eng::Container::getInstance().find("Omni001"));
-   tire = dynamic_cast<Eng::Mesh&>(Eng::Container::getInstance().find("Tube001"));
+   //Eng::Ovo::Loading loading = ovo.loadAsync("simple3dScene.ovo");
+   Eng::Ovo::Loading loading = ovo.loadAsync("scene.ovo");
+   if (loading.getStatus() == Eng::Ovo::Loading::Status::failed)
+      std::cout << "Unable to load the scene" << std::endl;
 
    float nearPlane = 1.0f;
    float farPlane = 200.0f;
    eng.setFarPlane(farPlane);
-   glm::mat4 lightProj = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
-   light.get().setProjMatrix(lightProj);
-
-   std::reference_wrapper<Eng::Light> light2 = dynamic_cast<Eng::Light&>(Eng::Container::getInstance().find("Omni002"));
-   light2.get().setProjMatrix(lightProj);
-   std::reference_wrapper<Eng::Light> light3 = dynamic_cast<Eng::Light&>(Eng::Container::getInstance().find("Omni003"));
-   light3.get().setProjMatrix(lightProj);
-
-   Eng::Mesh &hose = dynamic_cast<Eng::Mesh &>(Eng::Container::getInstance().find("Hose001"));
-   Eng::Mesh &hedra = dynamic_cast<Eng::Mesh &>(Eng::Container::getInstance().find("Hedra001"));
-   Eng::Mesh &chamfer = dynamic_cast<Eng::Mesh &>(Eng::Container::getInstance().find("ChamferCyl001"));
 
    // Rendering elements:
    Eng::List list;
+   list.setMultiDraw(true);
 
    // Init camera:   
    camera.setProjMatrix(glm::perspective(glm::radians(45.0f), eng.getWindowSize().x / (float)eng.getWindowSize().y, 1.0f, farPlane));
-   camera.lookAt(root); // Look at the origin
    lookAtRoot = true;
    
   
@@ -231,19 +518,55 @@ int main(int argc, char *argv[])
    {      
       auto start = timer.now();
 
+      // Scene loading (GPU uploads under a 2 ms budget per frame):
+      if (loading.getStatus() == Eng::Ovo::Loading::Status::loading)
+      {
+         loading.update(2.0f);
+         rootRef = loading.getRoot();
+         if (loading.getStatus() == Eng::Ovo::Loading::Status::done)
+         {
+            std::cout << "Scene graph:\n" << rootRef.get().getTreeAsString() << std::endl;
+
+            // Get light refs:
+            Eng::Container &container = Eng::Container::getInstance();
+            light = container.find<Eng::Light>("Omni001");
+            tire = container.find<Eng::Mesh>("Tube001");
+
+            glm::mat4 lightProj = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
+            light.get().setProjMatrix(lightProj);
+            container.find<Eng::Light>("Omni002").setProjMatrix(lightProj);
+            container.find<Eng::Light>("Omni003").setProjMatrix(lightProj);
+
+            hose = container.find<Eng::Mesh>("Hose001");
+            hedra = container.find<Eng::Mesh>("Hedra001");
+            chamfer = container.find<Eng::Mesh>("ChamferCyl001");
+
+            camera.lookAt(rootRef.get()); // Look at the origin
+         }
+         else
+            if (loading.getStatus() == Eng::Ovo::Loading::Status::failed)
+               std::cout << "Unable to load the scene" << std::endl;
+      }
+
       // Update viewpoint:
       camera.update();   
 
-      hose.setMatrix(glm::rotate(hose.getMatrix(), glm::radians(15.0f * fpsFactor), glm::vec3(0.0f, 1.0f, 0.0f)));
-      hedra.setMatrix(glm::rotate(hedra.getMatrix(), glm::radians(30.0f * fpsFactor), glm::vec3(0.0f, 1.0f, 0.0f)));
-      chamfer.setMatrix(glm::rotate(chamfer.getMatrix(), glm::radians(10.0f * fpsFactor), glm::vec3(10.0f, 0.0f, 1.0f)));
+      if (loading.getStatus() == Eng::Ovo::Loading::Status::done)
+      {
+         hose.get().setMatrix(glm::rotate(hose.get().getMatrix(), glm::radians(15.0f * fpsFactor), glm::vec3(0.0f, 1.0f, 0.0f)));
+         hedra.get().setMatrix(glm::rotate(hedra.get().getMatrix(), glm::radians(30.0f * fpsFactor), glm::vec3(0.0f, 1.0f, 0.0f)));
+         chamfer.get().setMatrix(glm::rotate(chamfer.get().getMatrix(), glm::radians(10.0f * fpsFactor), glm::vec3(10.0f, 0.0f, 1.0f)));
+      }
       
-      // Update list:
-      list.reset();
-      list.process(root);
-      
-      // Main rendering:
+      // Main rendering (once the root is attached):
       eng.clear();
+      if (rootRef.get() != Eng::Node::empty)
+      {
+         // Update list (LODs picked from the current viewpoint):
+         list.reset();
+         list.setLodViewpoint(camera);
+         list.process(rootRef);
+
          dfltPipe.render(camera, list);
 
          if (showShadowMap)
@@ -251,6 +574,7 @@ int main(int argc, char *argv[])
             eng.clear();      
             skyboxPipe.render(dfltPipe.getShadowMappingPipeline().getShadowMap(), list, camera);
          }
+      }
       eng.swap();    
 
       auto stop = timer.now();
@@ -13,6 +13,8 @@
 //////////////
    
    // C/C++:    
+   #include <cstring>
+   #include <type_traits>
    #include <iostream>
    #include <string>
    #include <vector>
@@ -72,6 +74,12 @@ namespace Eng {
    // Logging:
    #include "engine_log.h"
 
+   // Math:
+   #include "engine_math.h"
+
+   // Memory:
+   #include "engine_pool.h"
+
    // Architecture:
    #include "engine_object.h"
    #include "engine_managed.h"
@@ -85,6 +93,8 @@ namespace Eng {
    #include "engine_vao.h"
    #include "engine_vbo.h"
    #include "engine_ebo.h"
+   #include "engine_ssbo.h"
+   #include "engine_arena.h"
    #include "engine_shader.h"
    #include "engine_program.h"
    #include "engine_texture.h"
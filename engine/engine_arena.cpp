@@ -0,0 +1,635 @@
+/**
+ * @file		engine_arena.cpp
+ * @brief	Shared vertex/index storage for all the meshes
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <algorithm>
+   #include <iterator>
+   #include <limits>
+   #include <map>
+
+   // OGL:
+   #include <GL/glew.h>
+   #include <GLFW/glfw3.h>
+
+
+
+////////////
+// STATIC //
+////////////
+
+   // Set while the singleton exists (meshes released during static destruction may outlive it):
+   static bool arenaAvailable = false;
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief First-fit sub-allocator over a linear range, merging adjacent free blocks on release.
+ */
+struct FreeList
+{
+   std::map<uint64_t, uint64_t> blocks;   ///< Free blocks, offset -> size
+   uint64_t capacity;                     ///< Total size of the range
+   uint64_t used;                         ///< Allocated size
+
+
+   /**
+    * Constructor.
+    */
+   FreeList() : capacity{ 0 }, used{ 0 }
+   {}
+
+
+   /**
+    * Allocates a block.
+    * @param size block size
+    * @param offset block offset
+    * @return TF (false when no free block is large enough)
+    */
+   bool allocate(uint64_t size, uint64_t &offset)
+   {
+      for (auto it = blocks.begin(); it != blocks.end(); ++it)
+         if (it->second >= size)
+         {
+            offset = it->first;
+            const uint64_t remaining = it->second - size;
+            blocks.erase(it);
+            if (remaining)
+               blocks[offset + size] = remaining;
+            used += size;
+            return true;
+         }
+      return false;
+   }
+
+
+   /**
+    * Returns a block to the free list.
+    * @param offset block offset
+    * @param size block size
+    */
+   void release(uint64_t offset, uint64_t size)
+   {
+      used -= size;
+      insert(offset, size);
+   }
+
+
+   /**
+    * Extends the range, the new space being appended as free.
+    * @param newCapacity new size of the range
+    */
+   void grow(uint64_t newCapacity)
+   {
+      insert(capacity, newCapacity - capacity);
+      capacity = newCapacity;
+   }
+
+
+   /**
+    * Inserts a free block, merging it with its neighbours.
+    * @param offset block offset
+    * @param size block size
+    */
+   void insert(uint64_t offset, uint64_t size)
+   {
+      auto next = blocks.lower_bound(offset);
+      if (next != blocks.begin())
+      {
+         auto prev = std::prev(next);
+         if (prev->first + prev->second == offset)
+         {
+            offset = prev->first;
+            size += prev->second;
+            blocks.erase(prev);
+         }
+      }
+      if (next != blocks.end() && offset + size == next->first)
+      {
+         size += next->second;
+         blocks.erase(next);
+      }
+      blocks[offset] = size;
+   }
+};
+
+
+/**
+ * @brief Vertex storage of one layout.
+ */
+struct VertexPool
+{
+   GLuint vao;          ///< VAO, set up once for this layout
+   GLuint oglId;        ///< Vertex buffer
+   FreeList space;      ///< Sub-allocator, in vertices
+
+
+   /**
+    * Constructor.
+    */
+   VertexPool() : vao{ 0 }, oglId{ 0 }
+   {}
+};
+
+
+/**
+ * @brief Arena reserved structure.
+ */
+struct Eng::Arena::Reserved
+{
+   VertexPool pools[static_cast<uint32_t>(Eng::Vbo::Format::last)];  ///< Vertex storage, per layout
+   GLuint indexOglId;                                          ///< Index buffer, shared by all the layouts
+   FreeList indexSpace;                                        ///< Sub-allocator, in bytes
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : indexOglId{ 0 }
+   {}
+};
+
+
+
+////////////
+// STATIC //
+////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the size of one vertex in the given layout.
+ * @param format vertex layout
+ * @return size in bytes
+ */
+static uint64_t getVertexSize(Eng::Vbo::Format format)
+{
+   return (format == Eng::Vbo::Format::compact) ? sizeof(Eng::Vbo::CompactVertexData) : sizeof(Eng::Vbo::VertexData);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the space taken by the indices of a geometry, padded to keep the offsets 4-byte aligned.
+ * @param nrOfFaces number of faces
+ * @param indexType index type
+ * @return size in bytes
+ */
+static uint64_t getIndexBytes(uint32_t nrOfFaces, uint32_t indexType)
+{
+   const uint64_t size = static_cast<uint64_t>(nrOfFaces) * 3 * ((indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t));
+   return (size + 3) & ~static_cast<uint64_t>(3);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Creates an immutable buffer, copying the content of a previous one (released) into it.
+ * @param oldOglId previous buffer, or 0
+ * @param oldSize size of the previous buffer, in bytes
+ * @param newSize size of the new buffer, in bytes
+ * @return new buffer
+ */
+static GLuint createStorage(GLuint oldOglId, uint64_t oldSize, uint64_t newSize)
+{
+   GLuint oglId;
+   glGenBuffers(1, &oglId);
+   glBindBuffer(GL_COPY_WRITE_BUFFER, oglId);
+   glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newSize), nullptr, GL_DYNAMIC_STORAGE_BIT);
+   if (oldOglId)
+   {
+      glBindBuffer(GL_COPY_READ_BUFFER, oldOglId);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldSize));
+      glBindBuffer(GL_COPY_READ_BUFFER, 0);
+      glDeleteBuffers(1, &oldOglId);
+   }
+   glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+   return oglId;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Copies data into a buffer, leaving the current bindings untouched.
+ * @param oglId buffer
+ * @param offset destination offset, in bytes
+ * @param size size in bytes
+ * @param data source data
+ */
+static void uploadStorage(GLuint oglId, uint64_t offset, uint64_t size, const void *data)
+{
+   glBindBuffer(GL_COPY_WRITE_BUFFER, oglId);
+   glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+   glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+
+
+/////////////////////////
+// BODY OF CLASS Arena //
+/////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor with name.
+ * @param name node name
+ */
+ENG_API Eng::Arena::Arena(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Arena::Reserved>())
+{
+   ENG_LOG_DETAIL("[+]");
+   arenaAvailable = true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::Arena::~Arena()
+{
+   ENG_LOG_DETAIL("[-]");
+   arenaAvailable = false;
+   if (reserved)
+      this->free();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Get singleton instance.
+ */
+Eng::Arena ENG_API &Eng::Arena::getInstance()
+{
+   static Arena instance("[default]");
+   return instance;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether the singleton can still be accessed. Geometry released during static destruction must check it first,
+ * as the arena may have been destroyed already.
+ * @return TF
+ */
+bool ENG_API Eng::Arena::isAvailable()
+{
+   return arenaAvailable;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the capacity of the vertex buffer of the given layout.
+ * @param format vertex layout
+ * @return capacity in vertices, 0 if not created yet
+ */
+uint64_t ENG_API Eng::Arena::getVertexCapacity(Eng::Vbo::Format format) const
+{
+   if (format == Eng::Vbo::Format::last)
+      return 0;
+   return reserved->pools[static_cast<uint32_t>(format)].space.capacity;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the nr. of vertices currently allocated in the vertex buffer of the given layout.
+ * @param format vertex layout
+ * @return nr. of vertices
+ */
+uint64_t ENG_API Eng::Arena::getNrOfUsedVertices(Eng::Vbo::Format format) const
+{
+   if (format == Eng::Vbo::Format::last)
+      return 0;
+   return reserved->pools[static_cast<uint32_t>(format)].space.used;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the capacity of the index buffer.
+ * @return capacity in bytes
+ */
+uint64_t ENG_API Eng::Arena::getIndexCapacity() const
+{
+   return reserved->indexSpace.capacity;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the space currently allocated in the index buffer.
+ * @return size in bytes
+ */
+uint64_t ENG_API Eng::Arena::getNrOfUsedIndexBytes() const
+{
+   return reserved->indexSpace.used;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Initializes the arena (the index buffer is created at once, vertex buffers on first use).
+ * @return TF
+ */
+bool ENG_API Eng::Arena::init()
+{
+   if (this->Eng::Managed::init() == false)
+      return false;
+
+   // Create index storage:
+   reserved->indexOglId = createStorage(0, 0, defaultIndexCapacity);
+   reserved->indexSpace.grow(defaultIndexCapacity);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases the arena. Existing allocations become invalid.
+ * @return TF
+ */
+bool ENG_API Eng::Arena::free()
+{
+   if (this->Eng::Managed::free() == false)
+      return false;
+
+   // Release vertex storage:
+   for (auto &pool : reserved->pools)
+   {
+      if (pool.vao)
+         glDeleteVertexArrays(1, &pool.vao);
+      if (pool.oglId)
+         glDeleteBuffers(1, &pool.oglId);
+      pool = VertexPool();
+   }
+
+   // Release index storage:
+   if (reserved->indexOglId)
+      glDeleteBuffers(1, &reserved->indexOglId);
+   reserved->indexOglId = 0;
+   reserved->indexSpace = FreeList();
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Stores a geometry in the arena. Vertices are always given as VertexData and quantized on the fly when the compact
+ * layout is requested, indices are narrowed to 16 bits when possible. Buffers are grown when full.
+ * @param nrOfVertices number of vertices
+ * @param vertices pointer to the vertices (VertexData, not necessarily aligned)
+ * @param nrOfFaces number of faces
+ * @param faces pointer to the faces (FaceData, not necessarily aligned)
+ * @param format vertex layout to use on the GPU
+ * @param allocation resulting range of the arena
+ * @return TF
+ */
+bool ENG_API Eng::Arena::allocate(uint32_t nrOfVertices, const void *vertices, uint32_t nrOfFaces, const void *faces, Eng::Vbo::Format format, Allocation &allocation)
+{
+   // Safety net:
+   if (format == Eng::Vbo::Format::last || (nrOfVertices && vertices == nullptr) || (nrOfFaces && faces == nullptr))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Init storage:
+   if (!this->isInitialized())
+      this->init();
+   VertexPool &pool = reserved->pools[static_cast<uint32_t>(format)];
+   const uint64_t vertexSize = getVertexSize(format);
+   if (pool.oglId == 0)
+   {
+      pool.oglId = createStorage(0, 0, defaultVertexCapacity * vertexSize);
+      pool.space.grow(defaultVertexCapacity);
+
+      // Layout is set up once:
+      glGenVertexArrays(1, &pool.vao);
+      glBindVertexArray(pool.vao);
+      glBindVertexBuffer(0, pool.oglId, 0, static_cast<GLsizei>(vertexSize));
+      Eng::Vbo::setAttribFormat(format);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, reserved->indexOglId);
+      glBindVertexArray(0);
+   }
+
+   // Quantize, if needed:
+   glm::vec3 scale(1.0f), bias(0.0f);
+   std::vector<Eng::Vbo::CompactVertexData> compact;
+   if (format == Eng::Vbo::Format::compact)
+   {
+      compact.resize(nrOfVertices);
+      Eng::Vbo::quantize(nrOfVertices, vertices, compact.data(), scale, bias);
+      vertices = compact.data();
+   }
+
+   // Narrow indices, if possible (faces are read as raw memory, as they may not be aligned):
+   GLenum indexType = GL_UNSIGNED_INT;
+   std::vector<uint16_t> shortIndices;
+   const uint64_t nrOfIndices = static_cast<uint64_t>(nrOfFaces) * 3;
+   const uint8_t *indices = static_cast<const uint8_t *>(faces);
+   auto getIndex = [indices](uint64_t c)
+   {
+      uint32_t index;
+      std::memcpy(&index, indices + c * sizeof(uint32_t), sizeof(uint32_t));
+      return index;
+   };
+   uint64_t nrOfShortIndices = 0;
+   while (nrOfShortIndices < nrOfIndices && getIndex(nrOfShortIndices) <= std::numeric_limits<uint16_t>::max())
+      nrOfShortIndices++;
+   if (nrOfShortIndices == nrOfIndices)
+   {
+      indexType = GL_UNSIGNED_SHORT;
+      shortIndices.resize(nrOfIndices);
+      for (uint64_t c = 0; c < nrOfIndices; c++)
+         shortIndices[c] = static_cast<uint16_t>(getIndex(c));
+      faces = shortIndices.data();
+   }
+
+   // Vertex range:
+   uint64_t baseVertex = 0;
+   if (nrOfVertices && !pool.space.allocate(nrOfVertices, baseVertex))
+   {
+      const uint64_t newCapacity = std::max(pool.space.capacity * 2, pool.space.capacity + nrOfVertices);
+      if (newCapacity > static_cast<uint64_t>(std::numeric_limits<GLint>::max()))
+      {
+         ENG_LOG_ERROR("Vertex storage exhausted");
+         return false;
+      }
+      ENG_LOG_DEBUG("Vertex storage grown to %llu vertices", static_cast<unsigned long long>(newCapacity));
+      pool.oglId = createStorage(pool.oglId, pool.space.capacity * vertexSize, newCapacity * vertexSize);
+      pool.space.grow(newCapacity);
+      pool.space.allocate(nrOfVertices, baseVertex);
+
+      glBindVertexArray(pool.vao);
+      glBindVertexBuffer(0, pool.oglId, 0, static_cast<GLsizei>(vertexSize));
+      glBindVertexArray(0);
+   }
+
+   // Index range:
+   uint64_t indexOffset = 0;
+   const uint64_t indexBytes = getIndexBytes(nrOfFaces, indexType);
+   if (indexBytes && !reserved->indexSpace.allocate(indexBytes, indexOffset))
+   {
+      const uint64_t newCapacity = std::max(reserved->indexSpace.capacity * 2, reserved->indexSpace.capacity + indexBytes);
+      ENG_LOG_DEBUG("Index storage grown to %llu bytes", static_cast<unsigned long long>(newCapacity));
+      reserved->indexOglId = createStorage(reserved->indexOglId, reserved->indexSpace.capacity, newCapacity);
+      reserved->indexSpace.grow(newCapacity);
+      reserved->indexSpace.allocate(indexBytes, indexOffset);
+
+      // Shared by all the layouts:
+      for (auto &curPool : reserved->pools)
+         if (curPool.oglId)
+         {
+            glBindVertexArray(curPool.vao);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, reserved->indexOglId);
+         }
+      glBindVertexArray(0);
+   }
+
+   // Fill it:
+   if (nrOfVertices)
+      uploadStorage(pool.oglId, baseVertex * vertexSize, nrOfVertices * vertexSize, vertices);
+   if (nrOfIndices)
+      uploadStorage(reserved->indexOglId, indexOffset, nrOfIndices * ((indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t)), faces);
+
+   // Done:
+   allocation.format = format;
+   allocation.baseVertex = static_cast<uint32_t>(baseVertex);
+   allocation.nrOfVertices = nrOfVertices;
+   allocation.indexOffset = indexOffset;
+   allocation.nrOfFaces = nrOfFaces;
+   allocation.indexType = indexType;
+   allocation.scale = scale;
+   allocation.bias = bias;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the range used by a geometry to the arena. Allocations made before the arena was released are simply reset.
+ * @param allocation range to release, reset on return
+ * @return TF
+ */
+bool ENG_API Eng::Arena::release(Allocation &allocation)
+{
+   // Safety net:
+   if (allocation.format == Eng::Vbo::Format::last)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Give back both ranges:
+   if (this->isInitialized())
+   {
+      if (allocation.nrOfVertices)
+         reserved->pools[static_cast<uint32_t>(allocation.format)].space.release(allocation.baseVertex, allocation.nrOfVertices);
+      if (allocation.nrOfFaces)
+         reserved->indexSpace.release(allocation.indexOffset, getIndexBytes(allocation.nrOfFaces, allocation.indexType));
+   }
+
+   // Done:
+   allocation = Allocation();
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Copies a geometry back into system memory, as VertexData and FaceData (compact vertices are dequantized, 16-bit
+ * indices widened).
+ * @param allocation range to read
+ * @param vertices pointer to the destination vertices, holding allocation.nrOfVertices vertices
+ * @param faces pointer to the destination faces, holding allocation.nrOfFaces faces
+ * @return TF
+ */
+bool ENG_API Eng::Arena::download(const Allocation &allocation, void *vertices, void *faces) const
+{
+   // Safety net:
+   if (!this->isInitialized() || allocation.format == Eng::Vbo::Format::last ||
+       (allocation.nrOfVertices && vertices == nullptr) || (allocation.nrOfFaces && faces == nullptr))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Vertices:
+   if (allocation.nrOfVertices)
+   {
+      const VertexPool &pool = reserved->pools[static_cast<uint32_t>(allocation.format)];
+      const uint64_t vertexSize = getVertexSize(allocation.format);
+      glBindBuffer(GL_COPY_READ_BUFFER, pool.oglId);
+      if (allocation.format == Eng::Vbo::Format::standard)
+         glGetBufferSubData(GL_COPY_READ_BUFFER, static_cast<GLintptr>(allocation.baseVertex * vertexSize), static_cast<GLsizeiptr>(allocation.nrOfVertices * vertexSize), vertices);
+      else
+      {
+         std::vector<Eng::Vbo::CompactVertexData> compact(allocation.nrOfVertices);
+         glGetBufferSubData(GL_COPY_READ_BUFFER, static_cast<GLintptr>(allocation.baseVertex * vertexSize), static_cast<GLsizeiptr>(allocation.nrOfVertices * vertexSize), compact.data());
+         Eng::Vbo::dequantize(allocation.nrOfVertices, compact.data(), allocation.scale, allocation.bias, static_cast<Eng::Vbo::VertexData *>(vertices));
+      }
+   }
+
+   // Indices:
+   if (allocation.nrOfFaces)
+   {
+      const uint64_t nrOfIndices = static_cast<uint64_t>(allocation.nrOfFaces) * 3;
+      glBindBuffer(GL_COPY_READ_BUFFER, reserved->indexOglId);
+      if (allocation.indexType == GL_UNSIGNED_INT)
+         glGetBufferSubData(GL_COPY_READ_BUFFER, static_cast<GLintptr>(allocation.indexOffset), static_cast<GLsizeiptr>(nrOfIndices * sizeof(uint32_t)), faces);
+      else
+      {
+         std::vector<uint16_t> shortIndices(nrOfIndices);
+         glGetBufferSubData(GL_COPY_READ_BUFFER, static_cast<GLintptr>(allocation.indexOffset), static_cast<GLsizeiptr>(nrOfIndices * sizeof(uint16_t)), shortIndices.data());
+         std::copy(shortIndices.begin(), shortIndices.end(), static_cast<uint32_t *>(faces));
+      }
+   }
+   glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Rendering method. Binds the VAO of the given vertex layout, ready for glDrawElementsBaseVertex() calls using the
+ * offsets of an allocation.
+ * @param value vertex layout (Vbo::Format)
+ * @param data generic pointer to any kind of data
+ * @return TF
+ */
+bool ENG_API Eng::Arena::render(uint32_t value, void *data) const
+{
+   // Safety net:
+   if (value >= static_cast<uint32_t>(Eng::Vbo::Format::last) || reserved->pools[value].oglId == 0)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   glBindVertexArray(reserved->pools[value].vao);
+
+   // Done:
+   return true;
+}
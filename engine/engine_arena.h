@@ -0,0 +1,93 @@
+/**
+ * @file		engine_arena.h
+ * @brief	Shared vertex/index storage for all the meshes
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Geometry arena. Vertices and indices of all the meshes are sub-allocated from a few large immutable buffers
+ *        (one vertex buffer per layout, one index buffer shared by all of them), so that switching between meshes only
+ *        changes the offsets passed to the draw calls. Each layout owns a single VAO, set up once. Buffers grow by
+ *        doubling when full.
+ */
+class ENG_API Arena final : public Eng::Object, public Eng::Managed
+{
+//////////
+public: //
+//////////
+
+   // Consts:
+   static constexpr uint64_t defaultVertexCapacity = 256 * 1024;       ///< Initial capacity of each vertex buffer, in vertices
+   static constexpr uint64_t defaultIndexCapacity = 4 * 1024 * 1024;   ///< Initial capacity of the index buffer, in bytes
+
+
+   /**
+    * @brief Range of the arena used by one geometry. Vertices are addressed through baseVertex, so indices are local
+    *        to the geometry.
+    */
+   struct Allocation
+   {
+      Eng::Vbo::Format format;   ///< Vertex layout
+      uint32_t baseVertex;       ///< First vertex, within the vertex buffer of the layout
+      uint32_t nrOfVertices;     ///< Nr. of vertices
+      uint64_t indexOffset;      ///< First index, in bytes, within the index buffer
+      uint32_t nrOfFaces;        ///< Nr. of faces
+      uint32_t indexType;        ///< Index type (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT)
+      glm::vec3 scale;           ///< Position dequantization scale (compact layout)
+      glm::vec3 bias;            ///< Position dequantization bias (compact layout)
+
+
+      /**
+       * Constructor.
+       */
+      inline Allocation() noexcept : format{ Eng::Vbo::Format::standard }, baseVertex{ 0 }, nrOfVertices{ 0 },
+                                     indexOffset{ 0 }, nrOfFaces{ 0 }, indexType{ 0 }, scale{ 1.0f }, bias{ 0.0f }
+      {}
+   };
+
+
+   // Const/dest:
+   Arena(Arena const &) = delete;
+   ~Arena();
+
+   // Operators:
+   void operator=(Arena const &) = delete;
+
+   // Singleton:
+   static Arena &getInstance();
+   static bool isAvailable();
+
+   // Get/set:
+   uint64_t getVertexCapacity(Eng::Vbo::Format format) const;
+   uint64_t getNrOfUsedVertices(Eng::Vbo::Format format) const;
+   uint64_t getIndexCapacity() const;
+   uint64_t getNrOfUsedIndexBytes() const;
+
+   // Data:
+   bool allocate(uint32_t nrOfVertices, const void *vertices, uint32_t nrOfFaces, const void *faces, Eng::Vbo::Format format, Allocation &allocation);
+   bool release(Allocation &allocation);
+   bool download(const Allocation &allocation, void *vertices, void *faces) const;
+
+   // Rendering methods:
+   bool render(uint32_t value = 0, void *data = nullptr) const;
+
+   // Managed:
+   bool init() override;
+   bool free() override;
+
+
+///////////
+private: //
+///////////
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   // Const/dest:
+   Arena(const std::string &name);
+};
@@ -38,7 +38,7 @@
 /**
  * @brief Bitmap reserved structure.
  */
-struct Eng::Bitmap::Reserved
+struct Eng::Bitmap::Reserved : Eng::Pooled<Eng::Bitmap::Reserved>
 { 
    /**
     * @brief Bitmap layer.
@@ -85,6 +85,7 @@ struct Eng::Bitmap::Reserved
 ENG_API Eng::Bitmap::Bitmap() : reserved(std::make_unique<Eng::Bitmap::Reserved>())
 {		
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -95,6 +96,7 @@ ENG_API Eng::Bitmap::Bitmap() : reserved(std::make_unique<Eng::Bitmap::Reserved>
 ENG_API Eng::Bitmap::Bitmap(Format format, uint32_t sizeX, uint32_t sizeY, uint8_t *data) : reserved(std::make_unique<Eng::Bitmap::Reserved>())
 {
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
    load(format, sizeX, sizeY, data);
 }
 
@@ -107,6 +109,7 @@ ENG_API Eng::Bitmap::Bitmap(Format format, uint32_t sizeX, uint32_t sizeY, uint8
 ENG_API Eng::Bitmap::Bitmap(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Bitmap::Reserved>())
 {	   
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -117,6 +120,7 @@ ENG_API Eng::Bitmap::Bitmap(const std::string &name) : Eng::Object(name), reserv
 ENG_API Eng::Bitmap::Bitmap(Bitmap &&other) : Eng::Object(std::move(other)), reserved(std::move(other.reserved))
 {  
    ENG_LOG_DETAIL("[M]");
+   typeTags = tags;
 }
 
 
@@ -20,6 +20,9 @@ public: //
    // Special values:
    static Bitmap empty;   
 
+   // Type tags:
+   static constexpr uint32_t tags = Eng::Object::tags | static_cast<uint32_t>(Tag::bitmap);
+
    
    /**
     * @brief Types of bitmap format. 
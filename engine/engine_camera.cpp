@@ -42,7 +42,7 @@
 /**
  * @brief Camera class reserved structure.
  */
-struct Eng::Camera::Reserved
+struct Eng::Camera::Reserved : Eng::Pooled<Eng::Camera::Reserved>
 {  
    glm::mat4 projMatrix;   ///< Projection matrix
       
@@ -79,6 +79,7 @@ struct Eng::Camera::Reserved
 ENG_API Eng::Camera::Camera() : reserved(std::make_unique<Eng::Camera::Reserved>())
 {	
    ENG_LOG_DETAIL("[+]");   
+   typeTags = tags;
 }
 
 
@@ -90,6 +91,7 @@ ENG_API Eng::Camera::Camera() : reserved(std::make_unique<Eng::Camera::Reserved>
 ENG_API Eng::Camera::Camera(const std::string &name) : Eng::Node(name), reserved(std::make_unique<Eng::Camera::Reserved>())
 {	
    ENG_LOG_DETAIL("[+]");   
+   typeTags = tags;
 }
 
 
@@ -100,6 +102,7 @@ ENG_API Eng::Camera::Camera(const std::string &name) : Eng::Node(name), reserved
 ENG_API Eng::Camera::Camera(Camera &&other) : Eng::Node(std::move(other)), reserved(std::move(other.reserved))
 {  
    ENG_LOG_DETAIL("[M]");   
+   typeTags = tags;
 }
 
 
@@ -110,6 +113,10 @@ ENG_API Eng::Camera::Camera(Camera &&other) : Eng::Node(std::move(other)), reser
 ENG_API Eng::Camera::~Camera()
 {
    ENG_LOG_DETAIL("[-]");   
+
+   // Not the last rendered camera anymore:
+   if (&cache.get() == this)
+      cache = Eng::Camera::empty;
 }
 
 
@@ -146,6 +153,17 @@ void ENG_API Eng::Camera::lookAt(const Eng::Node &target)
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the center of the orbit.
+ * @return target node, or empty node if not used
+ */
+const Eng::Node ENG_API &Eng::Camera::getTarget() const
+{
+   return reserved->target;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Rotates camera around azimuth.
@@ -215,7 +233,7 @@ void ENG_API Eng::Camera::update()
    // @TODO: we should probably remove the parent's node final matrix here
    //        if the camera is in a hierarchy
    glm::mat4 lookAtMat = glm::lookAt(eyePos, center, reserved->up);
-   lookAtMat = glm::inverse(lookAtMat);
+   lookAtMat = Eng::Math::inverse(lookAtMat);
    this->setMatrix(lookAtMat);   
 }
 
@@ -241,7 +259,7 @@ Eng::Camera ENG_API &Eng::Camera::getCached()
  */
 bool ENG_API Eng::Camera::render(uint32_t value, void *data) const
 {	
-   Eng::Program &program = dynamic_cast<Eng::Program &>(Eng::Program::getCached());
+   Eng::Program &program = Eng::Program::getCached();
    program.setMat4("projectionMat", reserved->projMatrix);
    
    // Done:
@@ -20,6 +20,9 @@ public: //
    // Special values:
    static Camera empty;   
 
+   // Type tags:
+   static constexpr uint32_t tags = Eng::Node::tags | static_cast<uint32_t>(Tag::camera);
+
    // Const/dest:
    Camera();
    Camera(Camera &&other);
@@ -41,6 +44,7 @@ public: //
    void rotatePolar(float degrees);
    void zoom(float by);
    void lookAt(const Eng::Node &target);
+   const Eng::Node &getTarget() const;
    void update();
 
    // Rendering methods:   
@@ -17,6 +17,7 @@
    // C/C++:
    #include <algorithm>
    #include <variant>
+   #include <unordered_map>
 
 
 
@@ -38,20 +39,133 @@
  */
 struct Eng::Container::Reserved
 {
-   std::list<Eng::Node> allNodes;
-   std::list<Eng::Mesh> allMeshes;
-   std::list<Eng::Camera> allCameras;
-   std::list<Eng::Light> allLights;
-   std::list<Eng::Bitmap> allBitmaps;
-   std::list<Eng::Material> allMaterials;
-   std::list<Eng::Texture> allTextures;
+   Eng::Colony<Eng::Node> allNodes;
+   Eng::Colony<Eng::Mesh> allMeshes;
+   Eng::Colony<Eng::Camera> allCameras;
+   Eng::Colony<Eng::Light> allLights;
+   Eng::Colony<Eng::Bitmap> allBitmaps;
+   Eng::Colony<Eng::Material> allMaterials;
+   Eng::Colony<Eng::Texture> allTextures;
+
+   /**
+    * @brief Entry of the ID index.
+    */
+   struct Entry
+   {
+      Eng::Object *object;    ///< Object
+      Type type;              ///< Stored type
+      uint32_t slot;          ///< Slot within the storage of its type
+      uint64_t order;         ///< Insertion order
+   };
+
+   // Indexes:
+   template <typename K, typename V>
+   using Index = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, Eng::PoolAllocator<std::pair<const K, V>>>;
+   Index<std::string, std::vector<Eng::Object *>> names[static_cast<uint32_t>(Type::last)];   ///< Per type, objects with a given name (in order of insertion)
+   Index<uint32_t, Entry> ids;                                                                 ///< Object (with type, slot and order) with a given ID
+   uint64_t nrOfInsertions;                                                                    ///< Objects added so far
+   Eng::Container *owner;                                                                      ///< Container notified of the renames
    
 
    /**
     * Constructor.
+    * @param owner container notified when a stored object is renamed
     */
-   Reserved()
+   Reserved(Eng::Container *owner) : nrOfInsertions{ 0 }, owner{ owner }
    {}
+
+
+   /**
+    * Calls a function on the storage of the given type.
+    * @param type stored type
+    * @param f function taking the colony as parameter
+    */
+   template <typename F>
+   void visit(Type type, F &&f)
+   {
+      switch (type)
+      {
+         case Type::material: f(allMaterials); break;
+         case Type::texture:  f(allTextures); break;
+         case Type::mesh:     f(allMeshes); break;
+         case Type::camera:   f(allCameras); break;
+         case Type::light:    f(allLights); break;
+         case Type::node:     f(allNodes); break;
+         case Type::bitmap:   f(allBitmaps); break;
+         default: break;
+      }
+   }
+
+
+   /**
+    * Moves an object into the storage of its type and indexes it.
+    * @param colony storage of the type
+    * @param obj object to move
+    * @param type stored type
+    */
+   template <typename T>
+   void insert(Eng::Colony<T> &colony, T &&obj, Type type)
+   {
+      T &stored = colony.emplace(std::move(obj));
+      ids[stored.getId()] = { &stored, type, static_cast<uint32_t>(colony.getLastSlot()), nrOfInsertions++ };
+      index(stored, type);
+      stored.setContainer(owner);
+   }
+
+
+   /**
+    * Gets the insertion order of an indexed object.
+    * @param obj indexed object
+    * @return insertion order
+    */
+   uint64_t getOrder(const Eng::Object &obj) const
+   {
+      return ids.find(obj.getId())->second.order;
+   }
+
+
+   /**
+    * Adds an object to the name index of its type, after the objects with the same name and type added before it.
+    * @param obj object to index (already in the ID index)
+    * @param type stored type of the object
+    */
+   void index(Eng::Object &obj, Type type)
+   {
+      if (obj.getName().empty())
+         return;
+
+      std::vector<Eng::Object *> &same = names[static_cast<uint32_t>(type)][obj.getName()];
+      const uint64_t order = getOrder(obj);
+      if (same.empty() || getOrder(*same.back()) < order) // Usual case: the newest one
+         same.push_back(&obj);
+      else
+         same.insert(std::upper_bound(same.begin(), same.end(), order, [this](uint64_t o, const Eng::Object *other) { return o < getOrder(*other); }), &obj);
+   }
+
+
+   /**
+    * Removes an object from the name index of its type. The next object with the same name and type, if any, takes 
+    * its place.
+    * @param obj object to unindex (still in the ID index)
+    * @param type stored type of the object
+    * @param name name the object was indexed with
+    */
+   void unindex(Eng::Object &obj, Type type, const std::string &name)
+   {
+      auto &index = names[static_cast<uint32_t>(type)];
+      auto it = index.find(name);
+      if (it == index.end())
+         return;
+
+      std::vector<Eng::Object *> &same = it->second;
+      const uint64_t order = getOrder(obj);
+      auto pos = std::lower_bound(same.begin(), same.end(), order, [this](const Eng::Object *other, uint64_t o) { return getOrder(*other) < o; });
+      if (pos != same.end() && *pos == &obj)
+         same.erase(pos);
+      if (same.empty())
+         index.erase(it);
+   }
+
 };
 
 
@@ -64,7 +178,7 @@ struct Eng::Container::Reserved
 /**
  * Constructor.
  */
-ENG_API Eng::Container::Container() : reserved(std::make_unique<Eng::Container::Reserved>())
+ENG_API Eng::Container::Container() : reserved(std::make_unique<Eng::Container::Reserved>(this))
 {
    ENG_LOG_DETAIL("[+]");
 }
@@ -75,7 +189,7 @@ ENG_API Eng::Container::Container() : reserved(std::make_unique<Eng::Container::
  * Constructor with name.
  * @param name node name
  */
-ENG_API Eng::Container::Container(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Container::Reserved>())
+ENG_API Eng::Container::Container(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Container::Reserved>(this))
 {
    ENG_LOG_DETAIL("[+]");
 }
@@ -88,6 +202,11 @@ ENG_API Eng::Container::Container(const std::string &name) : Eng::Object(name),
 ENG_API Eng::Container::Container(Container &&other) : Eng::Object(std::move(other)), reserved(std::move(other.reserved))
 {
    ENG_LOG_DETAIL("[M]");
+
+   // Renames are now notified to this container:
+   reserved->owner = this;
+   for (auto &e : reserved->ids)
+      e.second.object->setContainer(this);
 }
 
 
@@ -119,10 +238,8 @@ Eng::Container ENG_API &Eng::Container::getInstance()
  */
 Eng::Node ENG_API &Eng::Container::getLastNode() const
 {
-   // Safety net:
-   if (reserved->allNodes.empty())
-      return Eng::Node::empty;
-   return reserved->allNodes.back();
+   Eng::Node *last = reserved->allNodes.getLast();
+   return last ? *last : Eng::Node::empty;
 }
 
 
@@ -133,10 +250,8 @@ Eng::Node ENG_API &Eng::Container::getLastNode() const
  */
 Eng::Mesh ENG_API &Eng::Container::getLastMesh() const
 {
-   // Safety net:
-   if (reserved->allMeshes.empty())
-      return Eng::Mesh::empty;
-   return reserved->allMeshes.back();
+   Eng::Mesh *last = reserved->allMeshes.getLast();
+   return last ? *last : Eng::Mesh::empty;
 }
 
 
@@ -147,10 +262,8 @@ Eng::Mesh ENG_API &Eng::Container::getLastMesh() const
  */
 Eng::Camera ENG_API &Eng::Container::getLastCamera() const
 {
-   // Safety net:
-   if (reserved->allCameras.empty())
-      return Eng::Camera::empty;
-   return reserved->allCameras.back();
+   Eng::Camera *last = reserved->allCameras.getLast();
+   return last ? *last : Eng::Camera::empty;
 }
 
 
@@ -161,10 +274,8 @@ Eng::Camera ENG_API &Eng::Container::getLastCamera() const
  */
 Eng::Light ENG_API &Eng::Container::getLastLight() const
 {
-   // Safety net:
-   if (reserved->allLights.empty())
-      return Eng::Light::empty;
-   return reserved->allLights.back();
+   Eng::Light *last = reserved->allLights.getLast();
+   return last ? *last : Eng::Light::empty;
 }
 
 
@@ -175,10 +286,8 @@ Eng::Light ENG_API &Eng::Container::getLastLight() const
  */
 Eng::Bitmap ENG_API &Eng::Container::getLastBitmap() const
 {
-   // Safety net:
-   if (reserved->allBitmaps.empty())
-      return Eng::Bitmap::empty;
-   return reserved->allBitmaps.back();
+   Eng::Bitmap *last = reserved->allBitmaps.getLast();
+   return last ? *last : Eng::Bitmap::empty;
 }
 
 
@@ -189,10 +298,8 @@ Eng::Bitmap ENG_API &Eng::Container::getLastBitmap() const
  */
 Eng::Material ENG_API &Eng::Container::getLastMaterial() const
 {
-   // Safety net:
-   if (reserved->allMaterials.empty())
-      return Eng::Material::empty;
-   return reserved->allMaterials.back();
+   Eng::Material *last = reserved->allMaterials.getLast();
+   return last ? *last : Eng::Material::empty;
 }
 
 
@@ -203,10 +310,8 @@ Eng::Material ENG_API &Eng::Container::getLastMaterial() const
  */
 Eng::Texture ENG_API &Eng::Container::getLastTexture() const
 {
-   // Safety net:
-   if (reserved->allTextures.empty())
-      return Eng::Texture::empty;
-   return reserved->allTextures.back();
+   Eng::Texture *last = reserved->allTextures.getLast();
+   return last ? *last : Eng::Texture::empty;
 }
 
 
@@ -215,7 +320,7 @@ Eng::Texture ENG_API &Eng::Container::getLastTexture() const
  * Gets direct access to the list of nodes.
  * @return list of nodes
  */
-std::list<Eng::Node> ENG_API &Eng::Container::getNodeList()
+Eng::Colony<Eng::Node> ENG_API &Eng::Container::getNodeList()
 {  
    return reserved->allNodes;
 }
@@ -226,7 +331,7 @@ std::list<Eng::Node> ENG_API &Eng::Container::getNodeList()
  * Gets direct access to the list of meshes.
  * @return list of meshes
  */
-std::list<Eng::Mesh> ENG_API &Eng::Container::getMeshList()
+Eng::Colony<Eng::Mesh> ENG_API &Eng::Container::getMeshList()
 {
    return reserved->allMeshes;
 }
@@ -237,7 +342,7 @@ std::list<Eng::Mesh> ENG_API &Eng::Container::getMeshList()
  * Gets direct access to the list of cameras.
  * @return list of cameras
  */
-std::list<Eng::Camera> ENG_API &Eng::Container::getCameraList()
+Eng::Colony<Eng::Camera> ENG_API &Eng::Container::getCameraList()
 {
    return reserved->allCameras;
 }
@@ -248,7 +353,7 @@ std::list<Eng::Camera> ENG_API &Eng::Container::getCameraList()
  * Gets direct access to the list of lights.
  * @return list of lights
  */
-std::list<Eng::Light> ENG_API &Eng::Container::getLightList()
+Eng::Colony<Eng::Light> ENG_API &Eng::Container::getLightList()
 {
    return reserved->allLights;
 }
@@ -259,7 +364,7 @@ std::list<Eng::Light> ENG_API &Eng::Container::getLightList()
  * Gets direct access to the list of bitmaps.
  * @return list of bitmaps
  */
-std::list<Eng::Bitmap> ENG_API &Eng::Container::getBitmapList()
+Eng::Colony<Eng::Bitmap> ENG_API &Eng::Container::getBitmapList()
 {
    return reserved->allBitmaps;
 }
@@ -270,7 +375,7 @@ std::list<Eng::Bitmap> ENG_API &Eng::Container::getBitmapList()
  * Gets direct access to the list of materials.
  * @return list of materials
  */
-std::list<Eng::Material> ENG_API &Eng::Container::getMaterialList()
+Eng::Colony<Eng::Material> ENG_API &Eng::Container::getMaterialList()
 {
    return reserved->allMaterials;
 }
@@ -281,7 +386,7 @@ std::list<Eng::Material> ENG_API &Eng::Container::getMaterialList()
  * Gets direct access to the list of textures.
  * @return list of textures
  */
-std::list<Eng::Texture> ENG_API &Eng::Container::getTextureList()
+Eng::Colony<Eng::Texture> ENG_API &Eng::Container::getTextureList()
 {
    return reserved->allTextures;
 }
@@ -294,6 +399,32 @@ std::list<Eng::Texture> ENG_API &Eng::Container::getTextureList()
  * @return found object or empty
  */
 Eng::Object ENG_API &Eng::Container::find(const std::string &name) const
+{
+   return find(name, (1u << static_cast<uint32_t>(Type::last)) - 1);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns, if existing, the first object with the given ID among its various lists.
+ * @param id object id
+ * @return found object or empty
+ */
+Eng::Object ENG_API &Eng::Container::find(const uint32_t id) const
+{
+   return find(id, (1u << static_cast<uint32_t>(Type::last)) - 1);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns, if existing, the first object with the given name among the lists of the given types, through the name 
+ * indexes (lists are searched in the Type order, objects in order of insertion).
+ * @param name object name
+ * @param typeMask types to search (one bit per Type)
+ * @return found object or empty
+ */
+Eng::Object ENG_API &Eng::Container::find(const std::string &name, uint32_t typeMask) const
 {
    // Safety net:
    if (name.empty())
@@ -302,40 +433,13 @@ Eng::Object ENG_API &Eng::Container::find(const std::string &name) const
       return Eng::Object::empty;
    }
 
-   // Seach in materials:
-   for (auto &c : reserved->allMaterials)
-      if (c.getName() == name)
-         return c;
-
-   // Seach in textures:
-   for (auto &c : reserved->allTextures)
-      if (c.getName() == name)
-         return c;
-   
-   // Seach in geometries:
-   for (auto &c : reserved->allMeshes)
-      if (c.getName() == name)
-         return c;
-
-   // Seach in cameras:
-   for (auto &c : reserved->allCameras)
-      if (c.getName() == name)
-         return c;
-
-   // Seach in lights:
-   for (auto &c : reserved->allLights)
-      if (c.getName() == name)
-         return c;
-
-   // Seach in nodes:
-   for (auto &c : reserved->allNodes)
-      if (c.getName() == name)
-         return c;
-
-   // Seach in bitmaps:
-   for (auto &c : reserved->allBitmaps)
-      if (c.getName() == name)
-         return c;
+   for (uint32_t t = 0; t < static_cast<uint32_t>(Type::last); t++)
+      if (typeMask & (1u << t))
+      {
+         auto it = reserved->names[t].find(name);
+         if (it != reserved->names[t].end())
+            return *it->second.front();
+      }
    
    // Not found:
    return Eng::Object::empty;
@@ -344,53 +448,23 @@ Eng::Object ENG_API &Eng::Container::find(const std::string &name) const
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Returns, if existing, the first object with the given ID among its various lists.
+ * Returns, if existing, the object with the given ID among the lists of the given types, through the ID index.
  * @param id object id
+ * @param typeMask types to search (one bit per Type)
  * @return found object or empty
  */
-Eng::Object ENG_API &Eng::Container::find(const uint32_t id) const
+Eng::Object ENG_API &Eng::Container::find(uint32_t id, uint32_t typeMask) const
 {
    // Fast lane:
    if (id == 0)         
       return Eng::Object::empty;   
    
-   // Seach in materials:
-   for (auto &c : reserved->allMaterials)
-      if (c.getId() == id)
-         return c;
-
-   // Seach in textures:
-   for (auto &c : reserved->allTextures)
-      if (c.getId() == id)
-         return c;
-
-   // Seach in geometries:
-   for (auto &c : reserved->allMeshes)
-      if (c.getId() == id)
-         return c;
-
-   // Seach in cameras:
-   for (auto &c : reserved->allCameras)
-      if (c.getId() == id)
-         return c;
-
-   // Seach in lights:
-   for (auto &c : reserved->allLights)
-      if (c.getId() == id)
-         return c;
-
-   // Seach in nodes:
-   for (auto &c : reserved->allNodes)
-      if (c.getId() == id)
-         return c;
-
-   // Seach in bitmaps:
-   for (auto &c : reserved->allBitmaps)
-      if (c.getId() == id)
-         return c;
+   auto it = reserved->ids.find(id);
+   if (it == reserved->ids.end() || (typeMask & (1u << static_cast<uint32_t>(it->second.type))) == 0)
+      return Eng::Object::empty;
 
-   // Not found:
-   return Eng::Object::empty;
+   // Done:
+   return *it->second.object;
 }
 
 
@@ -408,6 +482,9 @@ bool ENG_API Eng::Container::reset()
    reserved->allBitmaps.clear();
    reserved->allMaterials.clear();   
    reserved->allTextures.clear();   
+   for (auto &n : reserved->names)
+      n.clear();
+   reserved->ids.clear();
    
    // Done:
    setDirty(true);
@@ -430,49 +507,180 @@ bool ENG_API Eng::Container::add(Eng::Object &obj)
    }
 
    // Sort by type:
-   if (dynamic_cast<Eng::Mesh *>(&obj))
+   if (obj.is<Eng::Mesh>())
    {
-      reserved->allMeshes.push_back(std::move(dynamic_cast<Eng::Mesh &>(obj)));      
+      reserved->insert(reserved->allMeshes, std::move(obj.as<Eng::Mesh>()), Type::mesh);
       return true;
    }
    else
-      if (dynamic_cast<Eng::Camera *>(&obj))
+      if (obj.is<Eng::Camera>())
       {
-         reserved->allCameras.push_back(std::move(dynamic_cast<Eng::Camera &>(obj)));
+         reserved->insert(reserved->allCameras, std::move(obj.as<Eng::Camera>()), Type::camera);
          return true;
       }
       else
-         if (dynamic_cast<Eng::Light *>(&obj))
+         if (obj.is<Eng::Light>())
          {
-            reserved->allLights.push_back(std::move(dynamic_cast<Eng::Light &>(obj)));      
+            reserved->insert(reserved->allLights, std::move(obj.as<Eng::Light>()), Type::light);
             return true;
          }
          else      
-            if (dynamic_cast<Eng::Node *>(&obj))
+            if (obj.is<Eng::Node>())
             {
-               reserved->allNodes.push_back(std::move(dynamic_cast<Eng::Node &>(obj)));         
+               reserved->insert(reserved->allNodes, std::move(obj.as<Eng::Node>()), Type::node);
                return true;
             }      
             else
-               if (dynamic_cast<Eng::Material *>(&obj))
+               if (obj.is<Eng::Material>())
                {
-                  reserved->allMaterials.push_back(std::move(dynamic_cast<Eng::Material &>(obj)));         
+                  reserved->insert(reserved->allMaterials, std::move(obj.as<Eng::Material>()), Type::material);
                   return true;
                }      
                else
-                  if (dynamic_cast<Eng::Texture *>(&obj))
+                  if (obj.is<Eng::Texture>())
                   {
-                     reserved->allTextures.push_back(std::move(dynamic_cast<Eng::Texture &>(obj)));         
+                     reserved->insert(reserved->allTextures, std::move(obj.as<Eng::Texture>()), Type::texture);
                      return true;
                   }      
                   else
-                     if (dynamic_cast<Eng::Bitmap *>(&obj))
+                     if (obj.is<Eng::Bitmap>())
                      {
-                        reserved->allBitmaps.push_back(std::move(dynamic_cast<Eng::Bitmap &>(obj)));
+                        reserved->insert(reserved->allBitmaps, std::move(obj.as<Eng::Bitmap>()), Type::bitmap);
                         return true;
                      }
    
    // Done:
    ENG_LOG_ERROR("Unsupported type");   
    return false;
-}
\ No newline at end of file
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the slot (and its current generation) of an object, through the ID index.
+ * @param obj object
+ * @param type stored type the object must have
+ * @param slot filled with the slot
+ * @param generation filled with the generation of the slot
+ * @return TF
+ */
+bool ENG_API Eng::Container::getSlot(const Eng::Object &obj, Type type, uint32_t &slot, uint32_t &generation) const
+{
+   auto it = reserved->ids.find(obj.getId());
+   if (it == reserved->ids.end() || it->second.object != &obj || it->second.type != type)
+      return false;
+
+   // Done:
+   slot = it->second.slot;
+   reserved->visit(type, [&](auto &colony) { generation = colony.getGeneration(slot); });
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the object in a slot, if the slot still has the given generation.
+ * @param type stored type
+ * @param slot slot
+ * @param generation generation of the slot
+ * @return object or empty if removed (or invalid)
+ */
+Eng::Object ENG_API &Eng::Container::resolve(Type type, uint32_t slot, uint32_t generation) const
+{
+   Eng::Object *obj = nullptr;
+   reserved->visit(type, [&](auto &colony) { obj = colony.get(slot, generation); });
+   return obj ? *obj : Eng::Object::empty;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Removes and destroys the object in a slot, after dropping the references the other objects of the container hold to
+ * it: a node is detached from its parent and from its children (which become roots) and is no longer the target of 
+ * any camera, a material is unset from the meshes using it, and a texture from the materials using it. A bitmap still
+ * used by a texture is not removed. Render lists holding the object must be processed again.
+ * @param type stored type
+ * @param slot slot
+ * @param generation generation of the slot
+ * @return TF
+ */
+bool ENG_API Eng::Container::remove(Type type, uint32_t slot, uint32_t generation)
+{
+   Eng::Object &obj = resolve(type, slot, generation);
+
+   // Safety net:
+   if (obj == Eng::Object::empty)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Drop the references to the object:
+   switch (type)
+   {
+      case Type::material:
+         for (auto &c : reserved->allMeshes)
+            if (&c.getMaterial() == &obj)
+               c.setMaterial(Eng::Material::empty);
+         break;
+
+      case Type::texture:
+         for (auto &c : reserved->allMaterials)
+            for (auto t : { Eng::Texture::Type::albedo, Eng::Texture::Type::normal, Eng::Texture::Type::roughness, Eng::Texture::Type::metalness })
+               if (&c.getTexture(t) == &obj)
+                  c.setTexture(Eng::Texture::empty, t);
+         break;
+
+      case Type::bitmap:
+         for (auto &c : reserved->allTextures)
+            if (&c.getBitmap() == &obj)
+            {
+               ENG_LOG_ERROR("Bitmap '%s' still used by texture '%s'", obj.getName().c_str(), c.getName().c_str());
+               return false;
+            }
+         break;
+
+      default: // Nodes
+      {
+         Eng::Node &node = obj.as<Eng::Node>();
+         Eng::Node &parent = node.getParent();
+         for (uint32_t c = 0; c < parent.getNrOfChildren(); c++)
+            if (&parent.getChild(c) == &node)
+            {
+               parent.removeChild(c);
+               break;
+            }
+         for (uint32_t c = node.getNrOfChildren(); c > 0; c--)
+            node.removeChild(c - 1);
+         for (auto &c : reserved->allCameras)
+            if (&c.getTarget() == &node)
+               c.lookAt(Eng::Node::empty);
+      }
+   }
+
+   // Unindex (the next object with the same name takes its place):
+   reserved->unindex(obj, type, obj.getName());
+   reserved->ids.erase(obj.getId());
+
+   // Done:
+   reserved->visit(type, [slot](auto &colony) { colony.erase(slot); });
+   setDirty(true);
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Moves a stored object to its new name in the name index (called by the object when renamed).
+ * @param obj renamed object
+ * @param oldName name the object was indexed with
+ */
+void ENG_API Eng::Container::rename(Eng::Object &obj, const std::string &oldName)
+{
+   auto it = reserved->ids.find(obj.getId());
+   if (it == reserved->ids.end() || it->second.object != &obj)
+      return;
+
+   reserved->unindex(obj, it->second.type, oldName);
+   reserved->index(obj, it->second.type);
+}
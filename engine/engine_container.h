@@ -9,7 +9,8 @@
 
 
 /**
- * @brief Class for storing data used during the life-cycle of the engine. 
+ * @brief Class for storing data used during the life-cycle of the engine. Objects of each type are kept in a Colony,
+ *        so that references to them stay valid while more objects are added.
  */
 class ENG_API Container final : public Eng::Object
 {
@@ -20,6 +21,39 @@ public: //
    // Special values:
    static Container empty;
 
+
+   /**
+    * @brief Generational handle to an object of the container (slot map style). A handle never dangles: once its 
+    *        object is removed, resolving the handle returns T::empty, even when a newer object reuses the slot.
+    */
+   template <typename T>
+   struct Handle
+   {
+      uint32_t slot;          ///< Slot within the storage of T
+      uint32_t generation;    ///< Generation of the slot (0 for an invalid handle)
+
+
+      /**
+       * Constructor.
+       */
+      Handle() : slot{ 0 }, generation{ 0 }
+      {}
+
+
+      /**
+       * Constructor with slot and generation.
+       * @param slot slot within the storage of T
+       * @param generation generation of the slot
+       */
+      Handle(uint32_t slot, uint32_t generation) : slot{ slot }, generation{ generation }
+      {}
+
+      // Operators:
+      bool operator==(const Handle &rhs) const { return slot == rhs.slot && generation == rhs.generation; }
+      bool operator!=(const Handle &rhs) const { return !(*this == rhs); }
+   };
+
+
    // Const/dest:   
    Container(Container const &) = delete;
    virtual ~Container();
@@ -31,6 +65,11 @@ public: //
    bool add(Eng::Object &obj);
    bool reset();
 
+   // Handles:
+   template <typename T> Handle<T> getHandle(const T &obj) const;
+   template <typename T> T &resolve(const Handle<T> &handle) const;
+   template <typename T> bool remove(const Handle<T> &handle);
+
    // Get/set:
    Eng::Node &getLastNode() const;
    Eng::Mesh &getLastMesh() const;   
@@ -39,27 +78,61 @@ public: //
    Eng::Bitmap &getLastBitmap() const;
    Eng::Material &getLastMaterial() const;   
    Eng::Texture &getLastTexture() const;   
-   std::list<Eng::Node> &getNodeList();
-   std::list<Eng::Mesh> &getMeshList();
-   std::list<Eng::Camera> &getCameraList();
-   std::list<Eng::Light> &getLightList();
-   std::list<Eng::Bitmap> &getBitmapList();
-   std::list<Eng::Material> &getMaterialList();
-   std::list<Eng::Texture> &getTextureList();
+   Eng::Colony<Eng::Node> &getNodeList();
+   Eng::Colony<Eng::Mesh> &getMeshList();
+   Eng::Colony<Eng::Camera> &getCameraList();
+   Eng::Colony<Eng::Light> &getLightList();
+   Eng::Colony<Eng::Bitmap> &getBitmapList();
+   Eng::Colony<Eng::Material> &getMaterialList();
+   Eng::Colony<Eng::Texture> &getTextureList();
    
    // Finders:
    Eng::Object &find(const std::string &name) const;   ///< By name
    Eng::Object &find(uint32_t id) const;               ///< By ID
+   template <typename T> T &find(const std::string &name) const;
+   template <typename T> T &find(uint32_t id) const;
 
 
 ///////////
 private: //
 ///////////
 
+   /**
+    * @brief Types of stored objects, in search order.
+    */
+   enum class Type : uint32_t
+   {
+      material,
+      texture,
+      mesh,
+      camera,
+      light,
+      node,
+      bitmap,
+
+      // Terminator:
+      last
+   };
+
    // Reserved:
    struct Reserved;
    std::unique_ptr<Reserved> reserved;
 
+   // Finders:
+   template <typename T> static constexpr uint32_t getTypeMask();
+   Eng::Object &find(const std::string &name, uint32_t typeMask) const;
+   Eng::Object &find(uint32_t id, uint32_t typeMask) const;
+
+   // Handles:
+   template <typename T> static constexpr Type getType();
+   bool getSlot(const Eng::Object &obj, Type type, uint32_t &slot, uint32_t &generation) const;
+   Eng::Object &resolve(Type type, uint32_t slot, uint32_t generation) const;
+   bool remove(Type type, uint32_t slot, uint32_t generation);
+
+   // Renames (notified by the objects):
+   friend class Object;
+   void rename(Eng::Object &obj, const std::string &oldName);
+
    // Const/dest:
    Container(const std::string &name);
    Container();
@@ -71,4 +144,119 @@ private: //
 
 
 
+//////////////////////
+// TEMPLATE METHODS //
+//////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the mask of the stored types (one bit per Type) that are, or derive from, T.
+ * @return type mask
+ */
+template <typename T>
+constexpr uint32_t Container::getTypeMask()
+{
+   return (std::is_base_of<T, Eng::Material>::value << static_cast<uint32_t>(Type::material)) |
+          (std::is_base_of<T, Eng::Texture>::value << static_cast<uint32_t>(Type::texture)) |
+          (std::is_base_of<T, Eng::Mesh>::value << static_cast<uint32_t>(Type::mesh)) |
+          (std::is_base_of<T, Eng::Camera>::value << static_cast<uint32_t>(Type::camera)) |
+          (std::is_base_of<T, Eng::Light>::value << static_cast<uint32_t>(Type::light)) |
+          (std::is_base_of<T, Eng::Node>::value << static_cast<uint32_t>(Type::node)) |
+          (std::is_base_of<T, Eng::Bitmap>::value << static_cast<uint32_t>(Type::bitmap));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns, if existing, the first object of type T (or derived) with the given name. Only the lists that can hold a T
+ * are searched, and no dynamic cast is needed.
+ * @param name object name
+ * @return found object or T::empty
+ */
+template <typename T>
+T &Container::find(const std::string &name) const
+{
+   static_assert(getTypeMask<T>() != 0, "Type not stored in the container");
+   Eng::Object &obj = find(name, getTypeMask<T>());
+   return (&obj == &Eng::Object::empty) ? T::empty : static_cast<T &>(obj);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns, if existing, the object of type T (or derived) with the given ID.
+ * @param id object id
+ * @return found object or T::empty
+ */
+template <typename T>
+T &Container::find(uint32_t id) const
+{
+   static_assert(getTypeMask<T>() != 0, "Type not stored in the container");
+   Eng::Object &obj = find(id, getTypeMask<T>());
+   return (&obj == &Eng::Object::empty) ? T::empty : static_cast<T &>(obj);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the stored type matching exactly T.
+ * @return stored type, or Type::last if T is not stored as such
+ */
+template <typename T>
+constexpr Container::Type Container::getType()
+{
+   return std::is_same<T, Eng::Material>::value ? Type::material :
+          std::is_same<T, Eng::Texture>::value ? Type::texture :
+          std::is_same<T, Eng::Mesh>::value ? Type::mesh :
+          std::is_same<T, Eng::Camera>::value ? Type::camera :
+          std::is_same<T, Eng::Light>::value ? Type::light :
+          std::is_same<T, Eng::Node>::value ? Type::node :
+          std::is_same<T, Eng::Bitmap>::value ? Type::bitmap : Type::last;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets a handle to an object of the container. T must be the exact type of the object (e.g., Mesh for a mesh).
+ * @param obj object
+ * @return handle, or an invalid handle if the object is not in the container (as a T)
+ */
+template <typename T>
+Container::Handle<T> Container::getHandle(const T &obj) const
+{
+   static_assert(getType<T>() != Type::last, "Type not stored in the container");
+   uint32_t slot, generation;
+   if (!getSlot(obj, getType<T>(), slot, generation))
+      return Handle<T>();
+   return Handle<T>(slot, generation);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the object referenced by a handle, in constant time.
+ * @param handle object handle
+ * @return object, or T::empty if removed (or invalid handle)
+ */
+template <typename T>
+T &Container::resolve(const Handle<T> &handle) const
+{
+   static_assert(getType<T>() != Type::last, "Type not stored in the container");
+   Eng::Object &obj = resolve(getType<T>(), handle.slot, handle.generation);
+   return (&obj == &Eng::Object::empty) ? T::empty : static_cast<T &>(obj);
+}
+
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Removes and destroys the object referenced by a handle. See the private remove() for how references to the object
+ * are dropped.
+ * @param handle object handle
+ * @return TF
+ */
+template <typename T>
+bool Container::remove(const Handle<T> &handle)
+{
+   static_assert(getType<T>() != Type::last, "Type not stored in the container");
+   return remove(getType<T>(), handle.slot, handle.generation);
+}
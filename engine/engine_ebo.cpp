@@ -14,6 +14,10 @@
    // Main include:
    #include "engine.h"
 
+   // C/C++:
+   #include <algorithm>
+   #include <limits>
+
    // OGL:      
    #include <GL/glew.h>
    #include <GLFW/glfw3.h>
@@ -40,12 +44,13 @@ struct Eng::Ebo::Reserved
 {  
    GLuint oglId;        ///< OpenGL shader ID
    uint32_t nrOfFaces;  ///< Nr. of faces
+   GLenum indexType;    ///< GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
 
 
    /**
     * Constructor.
     */
-   Reserved() : oglId{ 0 }, nrOfFaces{ 0 }
+   Reserved() : oglId{ 0 }, nrOfFaces{ 0 }, indexType{ GL_UNSIGNED_INT }
    {}
 };
 
@@ -120,6 +125,28 @@ uint32_t ENG_API Eng::Ebo::getNrOfFaces() const
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the OpenGL type of the indices stored in this EBO, to be passed to the drawing functions.
+ * @return GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+ */
+uint32_t ENG_API Eng::Ebo::getIndexType() const
+{
+   return reserved->indexType;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the size of a single index stored in this EBO.
+ * @return size in bytes (2 or 4)
+ */
+uint32_t ENG_API Eng::Ebo::getIndexSize() const
+{
+   return (reserved->indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Initializes an OpenGL EBO.
@@ -171,17 +198,33 @@ bool ENG_API Eng::Ebo::free()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Create element buffer by allocating the required storage.
+ * Create element buffer by allocating the required storage. Faces are always given as FaceData: 16-bit indices are 
+ * used on the GPU when all of them fit (meshes with less than 65536 vertices).
  * @param nfOfFaces number of faces to store
  * @param data pointer to the data to copy into the buffer
  * @return TF
  */
 bool ENG_API Eng::Ebo::create(uint32_t nrOfFaces, const void *data)
 {	
+   // Narrow indices, if possible:
+   GLenum indexType = GL_UNSIGNED_INT;
+   std::vector<uint16_t> shortIndices;
+   if (data)
+   {
+      const uint32_t *indices = static_cast<const uint32_t *>(data);
+      const uint64_t nrOfIndices = static_cast<uint64_t>(nrOfFaces) * 3;
+      if (std::all_of(indices, indices + nrOfIndices, [](uint32_t i) { return i <= std::numeric_limits<uint16_t>::max(); }))
+      {
+         indexType = GL_UNSIGNED_SHORT;
+         shortIndices.assign(indices, indices + nrOfIndices);
+         data = shortIndices.data();
+      }
+   }
+
    // Init buffer:
    if (!this->isInitialized())
       this->init();
-   uint64_t size = nrOfFaces * sizeof(FaceData); 
+   uint64_t size = nrOfFaces * 3 * ((indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t)); 
 
 	// Create it:		              
    const GLuint oglId = this->getOglHandle();
@@ -190,6 +233,41 @@ bool ENG_API Eng::Ebo::create(uint32_t nrOfFaces, const void *data)
 
    // Done:
    reserved->nrOfFaces = nrOfFaces;
+   reserved->indexType = indexType;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Copies the content of the buffer back into system memory, as FaceData (16-bit indices are widened). The destination 
+ * must hold getNrOfFaces() faces.
+ * @param data pointer to the destination memory
+ * @return TF
+ */
+bool ENG_API Eng::Ebo::download(void *data) const
+{
+   // Safety net:
+   if (data == nullptr || !this->isInitialized())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Copy-read target, to leave the current bindings untouched:
+   glBindBuffer(GL_COPY_READ_BUFFER, reserved->oglId);
+   if (reserved->indexType == GL_UNSIGNED_INT)
+      glGetBufferSubData(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(reserved->nrOfFaces) * sizeof(FaceData), data);
+   else
+   {
+      // Widen back to 32-bit indices:
+      std::vector<uint16_t> shortIndices(static_cast<size_t>(reserved->nrOfFaces) * 3);
+      glGetBufferSubData(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(shortIndices.size()) * sizeof(uint16_t), shortIndices.data());
+      std::copy(shortIndices.begin(), shortIndices.end(), static_cast<uint32_t *>(data));
+   }
+   glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+   // Done:
    return true;
 }
 
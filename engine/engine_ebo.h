@@ -46,9 +46,12 @@ public: //
    // Get/set:   
    uint32_t getNrOfFaces() const;
    uint32_t getOglHandle() const;
+   uint32_t getIndexType() const;
+   uint32_t getIndexSize() const;
 
    // Data:
    bool create(uint32_t nrOfFaces, const void *data = nullptr);
+   bool download(void *data) const;
 
    // Rendering methods:   
    bool render(uint32_t value = 0, void *data = nullptr) const;
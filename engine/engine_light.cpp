@@ -32,7 +32,7 @@
 /**
  * @brief Light reserved structure.
  */
-struct Eng::Light::Reserved
+struct Eng::Light::Reserved : Eng::Pooled<Eng::Light::Reserved>
 {  
    glm::vec3 color;              ///< Light color
    glm::vec3 ambient;            ///< Ambient color
@@ -60,6 +60,7 @@ struct Eng::Light::Reserved
 ENG_API Eng::Light::Light() : reserved(std::make_unique<Eng::Light::Reserved>())
 {	
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -71,6 +72,7 @@ ENG_API Eng::Light::Light() : reserved(std::make_unique<Eng::Light::Reserved>())
 ENG_API Eng::Light::Light(const std::string &name) : Eng::Node(name), reserved(std::make_unique<Eng::Light::Reserved>())
 {	   	
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -81,6 +83,7 @@ ENG_API Eng::Light::Light(const std::string &name) : Eng::Node(name), reserved(s
 ENG_API Eng::Light::Light(Light &&other) : Eng::Node(std::move(other)), reserved(std::move(other.reserved))
 {  
    ENG_LOG_DETAIL("[M]");
+   typeTags = tags;
 }
 
 
@@ -218,6 +221,38 @@ uint32_t ENG_API Eng::Light::loadChunk(Eng::Serializer &serial, void *data)
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Saves the specific information of a given object as a new chunk. Properties not kept by the light are written with 
+ * their default values.
+ * @param serial serial data
+ * @return TF
+ */
+bool ENG_API Eng::Light::saveChunk(Eng::Serializer &serial) const
+{
+   const uint64_t start = beginChunk(serial, Ovo::ChunkId::light);
+
+   // Node properties:
+   serial.serialize(this->getName());
+   serial.serialize(this->getMatrix());
+   serial.serialize(this->getNrOfChildren());
+   serial.serialize(std::string("[none]")); // Target
+
+   // Data:
+   serial.serialize(static_cast<uint8_t>(0));         // Subtype (omni)
+   serial.serialize(reserved->color);
+   serial.serialize(0.0f);                            // Radius
+   serial.serialize(glm::vec3(0.0f, 0.0f, -1.0f));    // Direction
+   serial.serialize(180.0f);                          // Cutoff
+   serial.serialize(0.0f);                            // Spot exponent
+   serial.serialize(static_cast<uint8_t>(1));         // Casts shadows
+   serial.serialize(static_cast<uint8_t>(0));         // Volumetric
+
+   // Done:
+   return endChunk(serial, start);
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Rendering method. 
@@ -227,7 +262,7 @@ uint32_t ENG_API Eng::Light::loadChunk(Eng::Serializer &serial, void *data)
  */
 bool ENG_API Eng::Light::render(uint32_t value, void *data) const
 {	   
-   Eng::Program &program = dynamic_cast<Eng::Program &>(Eng::Program::getCached());
+   Eng::Program &program = Eng::Program::getCached();
    program.setVec3("lightColor", reserved->color);   
    program.setVec3("lightAmbient", reserved->ambient);   
    program.setVec3("lightPosition", glm::vec3(this->getWorldMatrix()[3]));
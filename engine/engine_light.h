@@ -20,6 +20,9 @@ public: //
    // Special values:
    static Light empty;   
 
+   // Type tags:
+   static constexpr uint32_t tags = Eng::Node::tags | static_cast<uint32_t>(Tag::light);
+
    // Const/dest:
 	Light();      
 	Light(Light &&other);
@@ -42,6 +45,7 @@ public: //
    
    // Ovo:   
    uint32_t loadChunk(Eng::Serializer &serial, void *data = nullptr) override;
+   bool saveChunk(Eng::Serializer &serial) const override;
 
 
 ///////////
@@ -14,6 +14,20 @@
    // Main include:
    #include "engine.h"
 
+   // C/C++:
+   #include <algorithm>
+   #include <unordered_map>
+
+   // SIMD (baseline of any x86-64 CPU):
+#if defined(__SSE2__) || defined(_M_X64)
+   #define ENG_LIST_SSE
+   #include <emmintrin.h>
+#endif
+
+   // OGL:      
+   #include <GL/glew.h>
+   #include <GLFW/glfw3.h>
+
 
 
 ////////////
@@ -29,6 +43,131 @@
 // RESERVED STRUCTURES //
 /////////////////////////
 
+/**
+ * @brief Per-instance data, as read by the shaders (std430 layout).
+ */
+struct InstanceData
+{
+   glm::mat4 modelviewMat;                                  ///< Modelview matrix
+   glm::mat4 worldMat;                                      ///< World matrix
+   glm::mat4 normalMat;                                     ///< Normal matrix (upper 3x3 used)
+   uint32_t frustumMask;                                    ///< Frusta touched by the element (one bit each)
+   uint32_t padding[3];
+};
+
+
+/**
+ * @brief Meshes sharing geometry and material, rendered with a single draw call.
+ */
+struct Batch
+{
+   uint32_t first;                                          ///< First entry in the batch order
+   uint32_t nrOfElems;                                      ///< Number of renderable elements
+};
+
+
+/**
+ * @brief Indirect draw command (DrawElementsIndirectCommand layout).
+ */
+struct DrawCommand
+{
+   uint32_t count;                                          ///< Number of indices
+   uint32_t instanceCount;                                  ///< Number of instances
+   uint32_t firstIndex;                                     ///< First index, in indices, within the index buffer
+   int32_t baseVertex;                                      ///< Added to each index
+   uint32_t baseInstance;                                   ///< First instance
+};
+
+
+/**
+ * @brief Per-draw data, as read by the shaders through gl_DrawID (std430 layout).
+ */
+struct DrawData
+{
+   glm::mat4 modelviewMat;                                  ///< Modelview matrix
+   glm::mat4 worldMat;                                      ///< World matrix
+   glm::mat4 normalMat;                                     ///< Normal matrix (upper 3x3 used)
+   glm::vec4 vertexScale;                                   ///< Position dequantization scale (compact layout)
+   glm::vec4 vertexBias;                                    ///< Position dequantization bias (compact layout)
+   uint32_t material;                                       ///< Index in the material data
+   uint32_t frustumMask;                                    ///< Frusta touched by the element (one bit each)
+   uint32_t padding[2];
+};
+
+
+/**
+ * @brief Per-material data, as read by the shaders (std430 layout).
+ */
+struct MaterialData
+{
+   glm::vec4 emission;                                      ///< Emission (rgb)
+   glm::vec4 albedo;                                        ///< Albedo (rgb)
+   glm::vec4 params;                                        ///< Roughness, metalness, opacity
+   uint64_t textures[Eng::Material::maxNrOfTextures];       ///< Bindless texture handles
+};
+
+
+/**
+ * @brief Consecutive draw commands submitted with a single multi-draw call.
+ */
+struct DrawGroup
+{
+   uint32_t first;                                          ///< First command
+   uint32_t nrOfDraws;                                      ///< Number of commands
+   Eng::Vbo::Format format;                                 ///< Vertex layout
+   uint32_t indexType;                                      ///< Index type
+   std::reference_wrapper<const Eng::Material> material;    ///< Material (only when textures must be bound per group)
+};
+
+
+/**
+ * @brief Multi-draw data submitted by a pass. It is kept as long as the commands and the culling of the pass do not 
+ *        change, and the per-draw matrices as long as the camera does not either (e.g., for a pass rendered once per 
+ *        light).
+ */
+struct PassDraws
+{
+   bool valid;                                              ///< True when the data matches the commands and the culling
+   glm::mat4 cameraMatrix;                                  ///< Camera matrix the per-draw data was computed with
+   std::vector<uint32_t> drawOrder;                         ///< Indices of the commands to submit
+   std::vector<DrawGroup> groups;                           ///< Groups over the submitted commands
+   std::vector<DrawCommand> commandData;                    ///< Staging area for the submitted commands
+   std::vector<DrawData> drawData;                          ///< Staging area for the per-draw data
+   Eng::Ssbo commands;                                      ///< Submitted indirect draw commands on the GPU
+   Eng::Ssbo draws;                                         ///< Per-draw data on the GPU
+
+
+   /**
+    * Constructor.
+    */
+   PassDraws() : valid{ false }, cameraMatrix{ 1.0f }
+   {}
+};
+
+
+/**
+ * @brief Volume used by process() to reject whole subtrees.
+ */
+enum class SubtreeCulling : uint32_t
+{
+   none,                                                    ///< Keep everything
+   frustum,                                                 ///< Keep what touches a view frustum
+   range,                                                   ///< Keep what is within a distance from a point
+};
+
+
+/**
+ * @brief Bounds of the renderable elements in world coordinates, stored as structure of arrays so that each test runs 
+ *        over contiguous floats (vectorized by the compiler).
+ */
+struct WorldBounds
+{
+   std::vector<float> centerX, centerY, centerZ;            ///< Bounding box centers
+   std::vector<float> extentX, extentY, extentZ;            ///< Bounding box half sizes (axis-aligned)
+   std::vector<float> radius;                               ///< Bounding sphere radii (around the box centers)
+};
+
+
 /**
  * @brief List reserved structure.
  */
@@ -37,16 +176,425 @@ struct Eng::List::Reserved
    std::vector<Eng::List::RenderableElem> renderableElem;   ///< List of rendering elements
    uint32_t nrOfLights;                                     ///< Number of lights in the list (lights come first)
 
+   // Level of detail:
+   std::vector<float> lodThresholds;                        ///< Screen size thresholds between consecutive LODs
+   float lodHysteresis;                                     ///< Relative margin around each threshold
+   bool lodViewpoint;                                       ///< True when a viewpoint is set (otherwise LOD 0 only)
+   glm::vec3 eyePosition;                                   ///< Viewpoint position in world coordinates
+   float projScale;                                         ///< Vertical projection scale (1 / tan(fov / 2))
+   std::unordered_map<uint32_t, uint32_t> lastLod;          ///< LOD picked before the last reset(), per mesh ID
+   std::unordered_map<uint32_t, uint32_t> curLod;           ///< LOD picked since the last reset(), per mesh ID
+
+   // Instancing:
+   bool batched;                                            ///< True when the batches match the current elements
+   std::vector<uint32_t> batchOrder;                        ///< Indices of the mesh elements, grouped by batch
+   std::vector<Batch> batches;                              ///< Batches over batchOrder
+   std::vector<InstanceData> instanceData;                  ///< Staging area for the per-instance data
+   std::vector<uint32_t> visibleOrder;                      ///< Indices of the visible mesh elements, grouped by batch
+   std::vector<Batch> visibleBatches;                       ///< Batches over visibleOrder
+   Eng::Ssbo instances;                                     ///< Per-instance data on the GPU
+
+   // Culling:
+   SubtreeCulling subtreeCulling;                           ///< Volume subtrees are tested against in process()
+   glm::vec4 subtreePlanes[6];                              ///< Frustum planes (frustum mode)
+   glm::vec4 subtreeSphere;                                 ///< Position and range (range mode)
+   uint32_t culledPasses;                                   ///< Passes having frustum masks (one bit per Pass)
+   std::vector<uint32_t> frustumMasks[static_cast<uint32_t>(Eng::List::Pass::last)]; ///< Per pass, per element, frusta touched (one bit each, 0 when culled)
+   bool boundsBuilt;                                        ///< True when the bounds match the current elements
+   WorldBounds bounds;                                      ///< Bounds of the elements, in world coordinates
+
+   // Multi-draw:
+   bool multiDraw;                                          ///< True to submit meshes with glMultiDrawElementsIndirect
+   bool drawsBuilt;                                         ///< True when the commands match the current elements
+   std::vector<DrawCommand> drawCommands;                   ///< Commands of all the mesh elements, grouped
+   std::vector<uint32_t> drawElems;                         ///< Element of each command
+   std::vector<uint32_t> drawMaterials;                     ///< Material index of each command
+   std::vector<DrawGroup> drawGroups;                       ///< Groups over the commands
+   std::vector<std::reference_wrapper<const Eng::Material>> materials; ///< Materials used by the commands
+   std::vector<MaterialData> materialData;                  ///< Staging area for the per-material data
+   Eng::Ssbo materialBuffer;                                ///< Per-material data on the GPU
+   PassDraws passDraws[static_cast<uint32_t>(Eng::List::Pass::last)]; ///< Per pass, data submitted
+
 
    /**
     * Constructor. 
     */
-   Reserved() : nrOfLights{ 0 }
+   Reserved() : nrOfLights{ 0 },
+                lodThresholds{ 0.25f, 0.1f, 0.04f }, lodHysteresis{ 0.1f },
+                lodViewpoint{ false }, eyePosition{ 0.0f }, projScale{ 1.0f },
+                batched{ false },
+                subtreeCulling{ SubtreeCulling::none }, subtreeSphere{ 0.0f },
+                culledPasses{ 0 }, boundsBuilt{ false },
+                multiDraw{ false }, drawsBuilt{ false }
    {}
 };
 
 
 
+////////////
+// STATIC //
+////////////
+
+   // Layout check (must match the shaders and GL):
+   static_assert(sizeof(InstanceData) == 208, "Invalid InstanceData size");
+   static_assert(sizeof(DrawCommand) == 20, "Invalid DrawCommand size");
+   static_assert(sizeof(DrawData) == 240, "Invalid DrawData size");
+   static_assert(sizeof(MaterialData) == 80, "Invalid MaterialData size");
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Picks the level of detail matching a projected size. The threshold between LOD i and i + 1 is moved away from the 
+ * LOD used at the previous frame by the hysteresis margin, to avoid popping back and forth around it.
+ * @param size projected bounding sphere radius, relative to half the viewport height
+ * @param prevLod LOD used at the previous frame
+ * @param thresholds decreasing screen size thresholds
+ * @param hysteresis relative margin around each threshold
+ * @return level of detail
+ */
+static uint32_t selectLod(float size, uint32_t prevLod, const std::vector<float> &thresholds, float hysteresis)
+{
+   uint32_t lod = 0;
+   for (uint32_t c = 0; c < thresholds.size(); c++)
+   {
+      const float threshold = thresholds[c] * (prevLod > c ? 1.0f + hysteresis : 1.0f - hysteresis);
+      if (size < threshold)
+         lod = c + 1;
+   }
+
+   // Done:
+   return lod;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Groups the mesh elements sharing the same GPU buffers and material, keeping the order of first appearance.
+ * @param elems renderable elements
+ * @param nrOfLights number of lights (at the beginning of the elements)
+ * @param order resulting element indices, grouped by batch
+ * @param batches resulting batches
+ */
+static void buildBatches(const std::vector<Eng::List::RenderableElem> &elems, uint32_t nrOfLights, std::vector<uint32_t> &order, std::vector<Batch> &batches)
+{
+   // Assign each element to its batch:
+   std::unordered_map<uint64_t, uint32_t> batchIds;
+   std::vector<uint32_t> elemBatch(elems.size(), 0);
+   batches.clear();
+   for (uint32_t c = nrOfLights; c < elems.size(); c++)
+   {
+      const Eng::Mesh &mesh = elems[c].reference.get().as<Eng::Mesh>();
+      const uint64_t key = (static_cast<uint64_t>(mesh.getGeometryId(elems[c].lod)) << 32) | mesh.getMaterial().getId();
+      auto it = batchIds.emplace(key, static_cast<uint32_t>(batches.size())).first;
+      if (it->second == batches.size())
+         batches.push_back({ 0, 0 });
+      batches[it->second].nrOfElems++;
+      elemBatch[c] = it->second;
+   }
+
+   // Counting sort:
+   uint32_t first = 0;
+   for (auto &batch : batches)
+   {
+      batch.first = first;
+      first += batch.nrOfElems;
+   }
+   order.resize(first);
+   std::vector<uint32_t> fill(batches.size(), 0);
+   for (uint32_t c = nrOfLights; c < elems.size(); c++)
+   {
+      const Batch &batch = batches[elemBatch[c]];
+      order[batch.first + fill[elemBatch[c]]++] = c;
+   }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Builds the indirect draw commands of the mesh elements, grouped by what a single multi-draw call must share: vertex 
+ * layout, index type and, when textures cannot be passed as bindless handles, material.
+ * @param elems renderable elements
+ * @param nrOfLights number of lights (at the beginning of the elements)
+ * @param byMaterial true to also group by material
+ * @param commands resulting draw commands, ordered by group
+ * @param drawElems resulting element of each command
+ * @param drawMaterials resulting material index of each command
+ * @param groups resulting groups
+ * @param materials resulting materials, referenced by drawMaterials
+ */
+static void buildDraws(const std::vector<Eng::List::RenderableElem> &elems, uint32_t nrOfLights, bool byMaterial, std::vector<DrawCommand> &commands,
+                       std::vector<uint32_t> &drawElems, std::vector<uint32_t> &drawMaterials, std::vector<DrawGroup> &groups, 
+                       std::vector<std::reference_wrapper<const Eng::Material>> &materials)
+{
+   // Assign each element to its group and material:
+   std::unordered_map<uint64_t, uint32_t> groupIds;
+   std::unordered_map<uint32_t, uint32_t> materialIds;
+   std::vector<uint32_t> elemGroup(elems.size(), 0);
+   std::vector<uint32_t> elemMaterial(elems.size(), 0);
+   std::vector<uint32_t> groupFill;
+   groups.clear();
+   materials.clear();
+   for (uint32_t c = nrOfLights; c < elems.size(); c++)
+   {
+      const Eng::Mesh &mesh = static_cast<const Eng::Mesh &>(elems[c].reference.get());
+      const Eng::Arena::Allocation allocation = mesh.getAllocation(elems[c].lod);
+      if (allocation.nrOfFaces == 0)
+         continue;
+
+      const Eng::Material &material = mesh.getMaterial();
+      auto mat = materialIds.emplace(material.getId(), static_cast<uint32_t>(materials.size())).first;
+      if (mat->second == materials.size())
+         materials.push_back(material);
+      elemMaterial[c] = mat->second;
+
+      const uint64_t key = (byMaterial ? (static_cast<uint64_t>(material.getId()) << 32) : 0) |
+                           (static_cast<uint64_t>(allocation.format) << 1) | (allocation.indexType == GL_UNSIGNED_SHORT);
+      auto it = groupIds.emplace(key, static_cast<uint32_t>(groups.size())).first;
+      if (it->second == groups.size())
+      {
+         groups.push_back({ 0, 0, allocation.format, allocation.indexType, material });
+         groupFill.push_back(0);
+      }
+      groups[it->second].nrOfDraws++;
+      elemGroup[c] = it->second + 1; // 0 = not drawn
+   }
+
+   // Counting sort:
+   uint32_t first = 0;
+   for (auto &group : groups)
+   {
+      group.first = first;
+      first += group.nrOfDraws;
+   }
+   commands.resize(first);
+   drawElems.resize(first);
+   drawMaterials.resize(first);
+   for (uint32_t c = nrOfLights; c < elems.size(); c++)
+   {
+      if (elemGroup[c] == 0)
+         continue;
+      const uint32_t groupId = elemGroup[c] - 1;
+      const uint32_t draw = groups[groupId].first + groupFill[groupId]++;
+
+      const Eng::Mesh &mesh = static_cast<const Eng::Mesh &>(elems[c].reference.get());
+      const Eng::Arena::Allocation allocation = mesh.getAllocation(elems[c].lod);
+      const uint64_t indexSize = (allocation.indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+      commands[draw].count = allocation.nrOfFaces * 3;
+      commands[draw].instanceCount = 1;
+      commands[draw].firstIndex = static_cast<uint32_t>(allocation.indexOffset / indexSize);
+      commands[draw].baseVertex = static_cast<int32_t>(allocation.baseVertex);
+      commands[draw].baseInstance = 0;
+      drawElems[draw] = c;
+      drawMaterials[draw] = elemMaterial[c];
+   }
+}
+
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Extracts the normalized frustum planes from a view-projection matrix (a point p is inside when dot(plane.xyz, p) + 
+ * plane.w >= 0 for all the planes).
+ * @param matrix view-projection matrix
+ * @param planes resulting left, right, bottom, top, near and far planes
+ */
+static void extractPlanes(const glm::mat4 &matrix, glm::vec4 planes[6])
+{
+   const glm::mat4 t = glm::transpose(matrix);
+   planes[0] = t[3] + t[0];
+   planes[1] = t[3] - t[0];
+   planes[2] = t[3] + t[1];
+   planes[3] = t[3] - t[1];
+   planes[4] = t[3] + t[2];
+   planes[5] = t[3] - t[2];
+   for (uint32_t c = 0; c < 6; c++)
+      planes[c] /= glm::max(glm::length(glm::vec3(planes[c])), 1e-12f);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Transforms a box, returning the axis-aligned box enclosing the result.
+ * @param matrix transformation
+ * @param bboxMin box minimum
+ * @param bboxMax box maximum
+ * @param center resulting box center
+ * @param extent resulting box half size
+ */
+static void transformBox(const glm::mat4 &matrix, const glm::vec3 &bboxMin, const glm::vec3 &bboxMax, glm::vec3 &center, glm::vec3 &extent)
+{
+   const glm::vec3 halfSize = (bboxMax - bboxMin) * 0.5f;
+   const glm::vec3 localCenter = (bboxMin + bboxMax) * 0.5f;
+
+#ifdef ENG_LIST_SSE
+   // One matrix column per register:
+   const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+   const __m128 m0 = _mm_loadu_ps(glm::value_ptr(matrix[0]));
+   const __m128 m1 = _mm_loadu_ps(glm::value_ptr(matrix[1]));
+   const __m128 m2 = _mm_loadu_ps(glm::value_ptr(matrix[2]));
+   const __m128 m3 = _mm_loadu_ps(glm::value_ptr(matrix[3]));
+   const __m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, _mm_set1_ps(localCenter.x)), _mm_mul_ps(m1, _mm_set1_ps(localCenter.y))),
+                               _mm_add_ps(_mm_mul_ps(m2, _mm_set1_ps(localCenter.z)), m3));
+   const __m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(m0, absMask), _mm_set1_ps(halfSize.x)), _mm_mul_ps(_mm_and_ps(m1, absMask), _mm_set1_ps(halfSize.y))),
+                               _mm_mul_ps(_mm_and_ps(m2, absMask), _mm_set1_ps(halfSize.z)));
+   alignas(16) float result[8];
+   _mm_store_ps(result, c);
+   _mm_store_ps(result + 4, e);
+   center = glm::vec3(result[0], result[1], result[2]);
+   extent = glm::vec3(result[4], result[5], result[6]);
+#else
+   center = glm::vec3(matrix * glm::vec4(localCenter, 1.0f));
+   extent = glm::abs(glm::vec3(matrix[0])) * halfSize.x + glm::abs(glm::vec3(matrix[1])) * halfSize.y + glm::abs(glm::vec3(matrix[2])) * halfSize.z;
+#endif
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Computes the world bounds of the mesh elements, from the local bounding boxes of the meshes. The box is transformed 
+ * as an axis-aligned box enclosing the oriented one, the sphere encloses the box.
+ * @param elems renderable elements
+ * @param nrOfLights number of lights (at the beginning of the elements, left unbounded)
+ * @param bounds resulting bounds
+ */
+static void buildBounds(const std::vector<Eng::List::RenderableElem> &elems, uint32_t nrOfLights, WorldBounds &bounds)
+{
+   const size_t size = elems.size();
+   for (auto *v : { &bounds.centerX, &bounds.centerY, &bounds.centerZ, &bounds.extentX, &bounds.extentY, &bounds.extentZ, &bounds.radius })
+      v->assign(size, 0.0f);
+
+   for (uint32_t c = nrOfLights; c < size; c++)
+   {
+      const Eng::Mesh &mesh = static_cast<const Eng::Mesh &>(elems[c].reference.get());
+      const glm::vec3 &bboxMin = mesh.getBoundingBoxMin();
+      const glm::vec3 &bboxMax = mesh.getBoundingBoxMax();
+      if (glm::any(glm::greaterThan(bboxMin, bboxMax)))
+         continue; // Empty: nothing to draw
+
+      glm::vec3 center, extent;
+      transformBox(elems[c].matrix, bboxMin, bboxMax, center, extent);
+      bounds.centerX[c] = center.x;
+      bounds.centerY[c] = center.y;
+      bounds.centerZ[c] = center.z;
+      bounds.extentX[c] = extent.x;
+      bounds.extentY[c] = extent.y;
+      bounds.extentZ[c] = extent.z;
+      bounds.radius[c] = glm::length(extent);
+   }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tests the bounds of one element against frustum planes: sphere first, then box only when the sphere crosses a plane.
+ * @param bounds world bounds
+ * @param c element to test
+ * @param planes frustum planes
+ * @return 1 if inside or crossing the frustum, 0 otherwise
+ */
+static uint8_t testBounds(const WorldBounds &bounds, uint32_t c, const glm::vec4 planes[6])
+{
+   const float cx = bounds.centerX[c], cy = bounds.centerY[c], cz = bounds.centerZ[c], r = bounds.radius[c];
+   bool crossing = false;
+   for (uint32_t p = 0; p < 6; p++)
+   {
+      const float dist = planes[p].x * cx + planes[p].y * cy + planes[p].z * cz + planes[p].w;
+      if (dist < -r)
+         return 0;
+      crossing |= dist < r;
+   }
+   if (!crossing)
+      return 1;
+
+   // Box (tighter):
+   for (uint32_t p = 0; p < 6; p++)
+   {
+      const float dist = planes[p].x * cx + planes[p].y * cy + planes[p].z * cz + planes[p].w;
+      const float reach = glm::abs(planes[p].x) * bounds.extentX[c] + glm::abs(planes[p].y) * bounds.extentY[c] + glm::abs(planes[p].z) * bounds.extentZ[c];
+      if (dist < -reach)
+         return 0;
+   }
+   return 1;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tests bounds against frustum planes: spheres first, then boxes only for the spheres crossing a plane. With SSE2, 
+ * four elements are tested per step (boxes only for the groups where a sphere crosses a plane).
+ * @param bounds world bounds
+ * @param first first element to test
+ * @param planes frustum planes
+ * @param visible resulting visibility, 1 if inside or crossing the frustum (same size as the bounds)
+ */
+static void testBounds(const WorldBounds &bounds, uint32_t first, const glm::vec4 planes[6], std::vector<uint8_t> &visible)
+{
+   const uint32_t size = static_cast<uint32_t>(bounds.radius.size());
+   visible.assign(size, 1);
+   uint32_t c = first;
+
+#ifdef ENG_LIST_SSE
+   __m128 nx[6], ny[6], nz[6], d[6], ax[6], ay[6], az[6];
+   const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+   for (uint32_t p = 0; p < 6; p++)
+   {
+      nx[p] = _mm_set1_ps(planes[p].x);
+      ny[p] = _mm_set1_ps(planes[p].y);
+      nz[p] = _mm_set1_ps(planes[p].z);
+      d[p] = _mm_set1_ps(planes[p].w);
+      ax[p] = _mm_and_ps(nx[p], absMask);
+      ay[p] = _mm_and_ps(ny[p], absMask);
+      az[p] = _mm_and_ps(nz[p], absMask);
+   }
+
+   for (; c + 4 <= size; c += 4)
+   {
+      const __m128 cx = _mm_loadu_ps(bounds.centerX.data() + c);
+      const __m128 cy = _mm_loadu_ps(bounds.centerY.data() + c);
+      const __m128 cz = _mm_loadu_ps(bounds.centerZ.data() + c);
+      const __m128 r = _mm_loadu_ps(bounds.radius.data() + c);
+      const __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+
+      // Spheres:
+      __m128 in = _mm_castsi128_ps(_mm_set1_epi32(-1));
+      __m128 crossing = _mm_setzero_ps();
+      __m128 dist[6];
+      for (uint32_t p = 0; p < 6; p++)
+      {
+         dist[p] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)), _mm_add_ps(_mm_mul_ps(nz[p], cz), d[p]));
+         in = _mm_and_ps(in, _mm_cmpge_ps(dist[p], negR));
+         crossing = _mm_or_ps(crossing, _mm_cmplt_ps(dist[p], r));
+      }
+
+      // Boxes (tighter), where the sphere test was not conclusive:
+      const __m128 boxTest = _mm_and_ps(in, crossing);
+      if (_mm_movemask_ps(boxTest))
+      {
+         const __m128 ex = _mm_loadu_ps(bounds.extentX.data() + c);
+         const __m128 ey = _mm_loadu_ps(bounds.extentY.data() + c);
+         const __m128 ez = _mm_loadu_ps(bounds.extentZ.data() + c);
+         __m128 boxIn = _mm_castsi128_ps(_mm_set1_epi32(-1));
+         for (uint32_t p = 0; p < 6; p++)
+         {
+            const __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+            boxIn = _mm_and_ps(boxIn, _mm_cmpge_ps(dist[p], _mm_sub_ps(_mm_setzero_ps(), reach)));
+         }
+         in = _mm_andnot_ps(_mm_andnot_ps(boxIn, boxTest), in);
+      }
+
+      const int mask = _mm_movemask_ps(in);
+      for (uint32_t k = 0; k < 4; k++)
+         visible[c + k] = static_cast<uint8_t>((mask >> k) & 1);
+   }
+#endif
+
+   // Remaining elements:
+   for (; c < size; c++)
+      visible[c] = testBounds(bounds, c, planes);
+}
+
+
+
 ////////////////////////
 // BODY OF CLASS List //
 ////////////////////////
@@ -94,12 +642,19 @@ ENG_API Eng::List::~List()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Resets internal list.
+ * Resets internal list. The LODs picked so far become the reference of the hysteresis for the next process() calls 
+ * (meshes no longer processed are forgotten).
  */
 void ENG_API Eng::List::reset()
 {	
+   std::swap(reserved->lastLod, reserved->curLod);
+   reserved->curLod.clear();
    reserved->renderableElem.clear();
    reserved->nrOfLights = 0;
+   reserved->batched = false;
+   reserved->drawsBuilt = false;
+   reserved->culledPasses = 0;
+   reserved->boundsBuilt = false;
 }
 
 
@@ -149,7 +704,210 @@ const Eng::List::RenderableElem ENG_API &Eng::List::getRenderableElem(uint32_t e
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Recursively parses the scenegraph starting at the given node and append the parsed elements to this list. 
+ * Sets the screen size thresholds used to pick the level of detail of each mesh. The screen size is the projected 
+ * radius of the bounding sphere relative to half the viewport height: LOD i + 1 is used below thresholds[i].
+ * @param thresholds decreasing screen size thresholds (empty to always use LOD 0)
+ * @param hysteresis relative margin around each threshold (e.g., 0.1 for 10%)
+ * @return TF
+ */
+bool ENG_API Eng::List::setLodThresholds(const std::vector<float> &thresholds, float hysteresis)
+{
+   // Safety net:
+   if (hysteresis < 0.0f || hysteresis >= 1.0f || !std::is_sorted(thresholds.rbegin(), thresholds.rend()))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   reserved->lodThresholds = thresholds;
+   reserved->lodHysteresis = hysteresis;
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the screen size thresholds used to pick the level of detail.
+ * @return decreasing screen size thresholds
+ */
+const std::vector<float> ENG_API &Eng::List::getLodThresholds() const
+{
+   return reserved->lodThresholds;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the hysteresis margin used to pick the level of detail.
+ * @return relative margin around each threshold
+ */
+float ENG_API Eng::List::getLodHysteresis() const
+{
+   return reserved->lodHysteresis;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the viewpoint used by the next process() calls to pick the level of detail of each mesh. Until a viewpoint is 
+ * set, LOD 0 is always used.
+ * @param camera camera the list is processed for
+ */
+void ENG_API Eng::List::setLodViewpoint(const Eng::Camera &camera)
+{
+   reserved->lodViewpoint = true;
+   reserved->eyePosition = glm::vec3(camera.getWorldMatrix()[3]);
+   reserved->projScale = camera.getProjMatrix()[1][1];
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Makes process() reject the subtrees entirely outside of a view frustum, with one test on their bounds. Rejected 
+ * meshes are missing from all the passes (shadow casters included). Subtrees holding lights are always kept.
+ * @param viewProjectionMatrix projection matrix multiplied by the camera (view) matrix
+ */
+void ENG_API Eng::List::setSubtreeCulling(const glm::mat4 &viewProjectionMatrix)
+{
+   reserved->subtreeCulling = SubtreeCulling::frustum;
+   extractPlanes(viewProjectionMatrix, reserved->subtreePlanes);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Makes process() reject the subtrees entirely farther than a range from a position (e.g., a light and its range), 
+ * with one test on their bounds. Subtrees holding lights are always kept.
+ * @param position position in world coordinates
+ * @param range maximum distance
+ */
+void ENG_API Eng::List::setSubtreeCulling(const glm::vec3 &position, float range)
+{
+   reserved->subtreeCulling = SubtreeCulling::range;
+   reserved->subtreeSphere = glm::vec4(position, range);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Makes process() keep all the subtrees (default).
+ */
+void ENG_API Eng::List::disableSubtreeCulling()
+{
+   reserved->subtreeCulling = SubtreeCulling::none;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Culls the mesh elements against a view frustum. The result is kept for the given pass until the next reset() or 
+ * process(): render() then skips the elements outside of the frustum. Passes never culled render all the elements.
+ * @param viewProjectionMatrix projection matrix multiplied by the camera (view) matrix
+ * @param pass pass the visibility is computed for
+ * @return TF
+ */
+bool ENG_API Eng::List::cull(const glm::mat4 &viewProjectionMatrix, Eng::List::Pass pass) const
+{
+   return cull(std::vector<glm::mat4>{ viewProjectionMatrix }, pass);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Culls the mesh elements against several view frusta (e.g., the six faces of a cube map). An element is rendered by 
+ * the pass when it touches at least one of them; the frusta touched are passed to the shaders as a bit mask 
+ * (frustumMask uniform for Pass::casters, or field of the per-instance and per-draw data), so that layered passes can 
+ * skip the others.
+ * @param viewProjectionMatrices projection matrices multiplied by the camera (view) matrices, 32 at most
+ * @param pass pass the visibility is computed for
+ * @return TF
+ */
+bool ENG_API Eng::List::cull(const std::vector<glm::mat4> &viewProjectionMatrices, Eng::List::Pass pass) const
+{
+   // Safety net:
+   if (pass == Pass::none || pass == Pass::lights || pass == Pass::last ||
+       viewProjectionMatrices.empty() || viewProjectionMatrices.size() > 32)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // World bounds only depend on the elements:
+   if (!reserved->boundsBuilt)
+   {
+      buildBounds(reserved->renderableElem, reserved->nrOfLights, reserved->bounds);
+      reserved->boundsBuilt = true;
+   }
+
+   std::vector<uint32_t> &masks = reserved->frustumMasks[static_cast<uint32_t>(pass)];
+   masks.assign(reserved->renderableElem.size(), 0);
+   std::vector<uint8_t> visible;
+   for (uint32_t f = 0; f < viewProjectionMatrices.size(); f++)
+   {
+      glm::vec4 planes[6];
+      extractPlanes(viewProjectionMatrices[f], planes);
+      testBounds(reserved->bounds, reserved->nrOfLights, planes, visible);
+      for (uint32_t c = reserved->nrOfLights; c < masks.size(); c++)
+         masks[c] |= static_cast<uint32_t>(visible[c]) << f;
+   }
+   reserved->culledPasses |= 1u << static_cast<uint32_t>(pass);
+   reserved->passDraws[static_cast<uint32_t>(pass)].valid = false;
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether an element is rendered by the given pass, according to the last cull() for that pass.
+ * @param elemNr element position in the list
+ * @param pass type of pass
+ * @return true when visible (or when the pass is not culled), false otherwise
+ */
+bool ENG_API Eng::List::isVisible(uint32_t elemNr, Eng::List::Pass pass) const
+{
+   // Safety net:
+   if (elemNr >= reserved->renderableElem.size())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   return !(reserved->culledPasses & (1u << static_cast<uint32_t>(pass))) || reserved->frustumMasks[static_cast<uint32_t>(pass)][elemNr];
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Enables the multi-draw path: meshes are then submitted with a few glMultiDrawElementsIndirect calls (one per vertex 
+ * layout and index type, also per material when bindless textures are not supported), the shaders fetching matrices 
+ * and material properties by gl_DrawID. 
+ * @param flag true to enable, false to use one draw call per mesh (or batch of instances)
+ */
+void ENG_API Eng::List::setMultiDraw(bool flag)
+{
+   reserved->multiDraw = flag;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether the multi-draw path is enabled.
+ * @return TF
+ */
+bool ENG_API Eng::List::isMultiDraw() const
+{
+   return reserved->multiDraw;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Recursively parses the scenegraph starting at the given node and append the parsed elements to this list. Subtrees
+ * outside of the volume given to setSubtreeCulling() are skipped.
  * @param node starting node
  * @param prevMatrix previous node matrix
  * @return TF
@@ -166,16 +924,68 @@ bool ENG_API Eng::List::process(const Eng::Node &node, const glm::mat4 &prevMatr
    RenderableElem re;
    re.matrix = prevMatrix * node.getMatrix();
    re.reference = node;   
+
+   // Whole subtree out of the culling volume?
+   if (reserved->subtreeCulling != SubtreeCulling::none)
+   {
+      glm::vec3 bboxMin, bboxMax;
+      if (node.getSubtreeBounds(bboxMin, bboxMax))
+      {
+         if (glm::any(glm::greaterThan(bboxMin, bboxMax)))
+            return true; // Nothing to render
+
+         glm::vec3 center, extent;
+         transformBox(re.matrix, bboxMin, bboxMax, center, extent);
+         if (reserved->subtreeCulling == SubtreeCulling::frustum)
+         {
+            for (uint32_t c = 0; c < 6; c++)
+            {
+               const glm::vec3 normal = glm::vec3(reserved->subtreePlanes[c]);
+               if (glm::dot(normal, center) + reserved->subtreePlanes[c].w + glm::dot(glm::abs(normal), extent) < 0.0f)
+                  return true;
+            }
+         }
+         else 
+         {
+            const glm::vec3 distance = glm::max(glm::abs(glm::vec3(reserved->subtreeSphere) - center) - extent, 0.0f);
+            if (glm::dot(distance, distance) > reserved->subtreeSphere.w * reserved->subtreeSphere.w)
+               return true;
+         }
+      }
+   }
+   reserved->batched = false;
+   reserved->drawsBuilt = false;
+   reserved->culledPasses = 0;
+   reserved->boundsBuilt = false;
    
    // Store only renderable elements:
-   if (dynamic_cast<const Eng::Light *>(&node)) // Lights first
+   if (node.is<Eng::Light>()) // Lights first
    {
       reserved->renderableElem.insert(reserved->renderableElem.begin(), 1, re);
       reserved->nrOfLights++;
    }
    else
-      if (dynamic_cast<const Eng::Mesh *>(&node)) // Only meshes
+   {
+      const Eng::Mesh *mesh = node.is<Eng::Mesh>() ? &node.as<Eng::Mesh>() : nullptr;
+      if (mesh) // Only meshes
+      {
+         // Level of detail:
+         if (reserved->lodViewpoint && mesh->getNrOfLods() > 1)
+         {
+            const float scale = glm::sqrt(glm::max(glm::dot(glm::vec3(re.matrix[0]), glm::vec3(re.matrix[0])),
+                                          glm::max(glm::dot(glm::vec3(re.matrix[1]), glm::vec3(re.matrix[1])),
+                                                   glm::dot(glm::vec3(re.matrix[2]), glm::vec3(re.matrix[2])))));
+            const float distance = glm::max(glm::distance(reserved->eyePosition, glm::vec3(re.matrix[3])), 1e-4f);
+            const float size = mesh->getRadius() * scale * reserved->projScale / distance;
+
+            auto it = reserved->lastLod.find(mesh->getId());
+            const uint32_t lastLod = (it != reserved->lastLod.end()) ? it->second : 0;
+            re.lod = std::min(selectLod(size, lastLod, reserved->lodThresholds, reserved->lodHysteresis), mesh->getNrOfLods() - 1);
+            reserved->curLod[mesh->getId()] = re.lod;
+         }
          reserved->renderableElem.push_back(re);
+      }
+   }
 
    // Parse hierarchy recursively:
    for (auto &n : node.getListOfChildren())
@@ -189,7 +999,8 @@ bool ENG_API Eng::List::process(const Eng::Node &node, const glm::mat4 &prevMatr
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Parses the list and calls the render method of each renderable.
+ * Parses the list and calls the render method of each renderable. Meshes sharing the same geometry and material are 
+ * rendered with a single instanced draw call.
  * @param cameraMatrix camera (also view) matrix (must be already inverted)
  * @param projectionMatrix projection matrix
  * @param pass type of pass
@@ -214,19 +1025,224 @@ bool ENG_API Eng::List::render(const glm::mat4 &cameraMatrix, const glm::mat4 &p
          endRange = reserved->nrOfLights;
          break;
 
-      /////////////////////
-      case Pass::meshes: //
+      //////////////////////
+      case Pass::meshes:  //
+      case Pass::casters: //
          startRange = reserved->nrOfLights;
          break;
    }
 
-   // Iterate through the range:
-   for (size_t c = startRange; c < endRange; c++)
+   // Iterate through the lights in the range:
+   for (size_t c = startRange; c < std::min<size_t>(endRange, reserved->nrOfLights); c++)
    {      
       RenderableElem &re = reserved->renderableElem.at(c);
       glm::mat4 finalMatrix = cameraMatrix * re.matrix; 
-      re.reference.get().render(0, &finalMatrix);
+      re.reference.get().render(re.lod, &finalMatrix);
+   }
+   if (endRange <= reserved->nrOfLights)
+      return true;
+
+   // Meshes submitted with indirect draw commands:
+   if (reserved->multiDraw)
+      return renderMultiDraw(cameraMatrix, pass);
+
+   // Meshes sharing geometry and material are rendered as instances:
+   if (!reserved->batched)
+   {
+      buildBatches(reserved->renderableElem, reserved->nrOfLights, reserved->batchOrder, reserved->batches);
+      reserved->batched = true;
+   }
+
+   // Keep only the visible members of each batch, when culled:
+   const std::vector<uint32_t> *order = &reserved->batchOrder;
+   const std::vector<Batch> *batches = &reserved->batches;
+   const std::vector<uint32_t> *masks = nullptr;
+   if (reserved->culledPasses & (1u << static_cast<uint32_t>(pass)))
+   {
+      masks = &reserved->frustumMasks[static_cast<uint32_t>(pass)];
+      reserved->visibleOrder.clear();
+      reserved->visibleBatches.clear();
+      for (auto &batch : reserved->batches)
+      {
+         const uint32_t first = static_cast<uint32_t>(reserved->visibleOrder.size());
+         for (uint32_t c = batch.first; c < batch.first + batch.nrOfElems; c++)
+            if ((*masks)[reserved->batchOrder[c]])
+               reserved->visibleOrder.push_back(reserved->batchOrder[c]);
+         const uint32_t nrOfElems = static_cast<uint32_t>(reserved->visibleOrder.size()) - first;
+         if (nrOfElems)
+            reserved->visibleBatches.push_back({ first, nrOfElems });
+      }
+      order = &reserved->visibleOrder;
+      batches = &reserved->visibleBatches;
+   }
+
+   reserved->instanceData.clear();
+   for (auto &batch : *batches)
+      if (batch.nrOfElems > 1)
+         for (uint32_t c = batch.first; c < batch.first + batch.nrOfElems; c++)
+         {
+            const RenderableElem &re = reserved->renderableElem[(*order)[c]];
+            InstanceData &instance = reserved->instanceData.emplace_back();
+            instance.worldMat = re.matrix;
+            instance.frustumMask = masks ? (*masks)[(*order)[c]] : 0xFFFFFFFF;
+         }
+   if (!reserved->instanceData.empty())
+   {
+      // Modelview and normal matrices, in one sweep:
+      InstanceData &first = reserved->instanceData.front();
+      Eng::Math::multiply(cameraMatrix, &first.worldMat, &first.modelviewMat, reserved->instanceData.size(), sizeof(InstanceData), sizeof(InstanceData));
+      Eng::Math::normalMatrix(&first.modelviewMat, &first.normalMat, reserved->instanceData.size(), sizeof(InstanceData), sizeof(InstanceData));
+
+      reserved->instances.create(reserved->instanceData.size() * sizeof(InstanceData), reserved->instanceData.data());
+      reserved->instances.render(0);
+   }
+
+   uint32_t firstInstance = 0;
+   for (auto &batch : *batches)
+   {
+      const RenderableElem &re = reserved->renderableElem[(*order)[batch.first]];
+      if (batch.nrOfElems == 1)
+      {
+         if (masks && pass == Pass::casters) // Only the layered pass has the uniform
+            Eng::Program::getCached().setUInt("frustumMask", (*masks)[(*order)[batch.first]]);
+         glm::mat4 finalMatrix = cameraMatrix * re.matrix; 
+         re.reference.get().render(re.lod, &finalMatrix);
+      }
+      else
+      {
+         static_cast<const Eng::Mesh &>(re.reference.get()).renderInstances(re.lod, batch.nrOfElems, firstInstance);
+         firstInstance += batch.nrOfElems;
+      }
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Renders the mesh elements with indirect draw commands. Commands and per-material data (bound to shader storage 
+ * binding point 2) only depend on the elements and are built once per process(). Each pass then submits all the 
+ * commands, or only the visible ones when culled, with its per-draw data (binding point 1): both are kept until the 
+ * pass is culled again, and the matrices in the per-draw data until the camera changes.
+ * @param cameraMatrix camera (also view) matrix (must be already inverted)
+ * @param pass type of pass
+ * @return TF
+ */
+bool ENG_API Eng::List::renderMultiDraw(const glm::mat4 &cameraMatrix, Eng::List::Pass pass) const
+{
+   const bool bindless = Eng::Base::getInstance().isBindlessSupported();
+
+   // Draw commands and materials:
+   if (!reserved->drawsBuilt)
+   {
+      buildDraws(reserved->renderableElem, reserved->nrOfLights, !bindless, reserved->drawCommands, reserved->drawElems, reserved->drawMaterials, 
+                 reserved->drawGroups, reserved->materials);
+
+      reserved->materialData.resize(reserved->materials.size());
+      for (uint32_t c = 0; c < reserved->materials.size(); c++)
+      {
+         const Eng::Material &material = reserved->materials[c];
+         MaterialData &data = reserved->materialData[c];
+         data.emission = glm::vec4(material.getEmission(), 0.0f);
+         data.albedo = glm::vec4(material.getAlbedo(), 0.0f);
+         data.params = glm::vec4(material.getRoughness(), material.getMetalness(), material.getOpacity(), 0.0f);
+         const Eng::Texture::Type types[] = { Eng::Texture::Type::albedo, Eng::Texture::Type::normal, 
+                                              Eng::Texture::Type::roughness, Eng::Texture::Type::metalness };
+         for (uint32_t t = 0; t < Eng::Material::maxNrOfTextures; t++)
+         {
+            const Eng::Texture &texture = material.getTexture(types[t]);
+            data.textures[t] = (texture != Eng::Texture::empty) ? texture.getOglBindlessHandle() : Eng::Texture::getDefault().getOglBindlessHandle();
+         }
+      }
+      if (!reserved->materialData.empty())
+         reserved->materialBuffer.create(reserved->materialData.size() * sizeof(MaterialData), reserved->materialData.data());
+
+      for (auto &passDraws : reserved->passDraws)
+         passDraws.valid = false;
+      reserved->drawsBuilt = true;
+   }
+   if (reserved->drawElems.empty())
+      return true;
+
+   PassDraws &passDraws = reserved->passDraws[static_cast<uint32_t>(pass)];
+   if (!passDraws.valid || passDraws.cameraMatrix != cameraMatrix)
+   {
+      if (!passDraws.valid)
+      {
+         // Commands to submit (only the visible ones of each group, when culled):
+         const std::vector<uint32_t> *masks = nullptr;
+         if (reserved->culledPasses & (1u << static_cast<uint32_t>(pass)))
+            masks = &reserved->frustumMasks[static_cast<uint32_t>(pass)];
+         passDraws.drawOrder.clear();
+         passDraws.groups.clear();
+         passDraws.commandData.clear();
+         for (auto &group : reserved->drawGroups)
+         {
+            const uint32_t first = static_cast<uint32_t>(passDraws.drawOrder.size());
+            for (uint32_t c = group.first; c < group.first + group.nrOfDraws; c++)
+               if (masks == nullptr || (*masks)[reserved->drawElems[c]])
+               {
+                  passDraws.drawOrder.push_back(c);
+                  passDraws.commandData.push_back(reserved->drawCommands[c]);
+               }
+            const uint32_t nrOfDraws = static_cast<uint32_t>(passDraws.drawOrder.size()) - first;
+            if (nrOfDraws)
+               passDraws.groups.push_back({ first, nrOfDraws, group.format, group.indexType, group.material });
+         }
+         if (!passDraws.commandData.empty())
+            passDraws.commands.create(passDraws.commandData.size() * sizeof(DrawCommand), passDraws.commandData.data());
+
+         // Per-draw data not depending on the camera:
+         passDraws.drawData.resize(passDraws.drawOrder.size());
+         for (uint32_t c = 0; c < passDraws.drawOrder.size(); c++)
+         {
+            const uint32_t elem = reserved->drawElems[passDraws.drawOrder[c]];
+            const RenderableElem &re = reserved->renderableElem[elem];
+            const Eng::Arena::Allocation allocation = static_cast<const Eng::Mesh &>(re.reference.get()).getAllocation(re.lod);
+            DrawData &draw = passDraws.drawData[c];
+            draw.worldMat = re.matrix;
+            draw.vertexScale = glm::vec4(allocation.scale, 0.0f);
+            draw.vertexBias = glm::vec4(allocation.bias, 0.0f);
+            draw.material = reserved->drawMaterials[passDraws.drawOrder[c]];
+            draw.frustumMask = masks ? (*masks)[elem] : 0xFFFFFFFF;
+         }
+      }
+
+      // Modelview and normal matrices, in one sweep:
+      if (!passDraws.drawData.empty())
+      {
+         DrawData &first = passDraws.drawData.front();
+         Eng::Math::multiply(cameraMatrix, &first.worldMat, &first.modelviewMat, passDraws.drawData.size(), sizeof(DrawData), sizeof(DrawData));
+         Eng::Math::normalMatrix(&first.modelviewMat, &first.normalMat, passDraws.drawData.size(), sizeof(DrawData), sizeof(DrawData));
+         passDraws.draws.create(passDraws.drawData.size() * sizeof(DrawData), passDraws.drawData.data());
+      }
+      passDraws.cameraMatrix = cameraMatrix;
+      passDraws.valid = true;
+   }
+   if (passDraws.drawOrder.empty())
+      return true;
+   passDraws.draws.render(1);
+   reserved->materialBuffer.render(2);
+
+   // Submit:
+   Eng::Program &program = Eng::Program::getCached();
+   program.setInt("instanced", 0);
+   program.setInt("multiDraw", 1);
+   glBindBuffer(GL_DRAW_INDIRECT_BUFFER, passDraws.commands.getOglHandle());
+   for (auto &group : passDraws.groups)
+   {
+      if (!bindless)
+         group.material.get().render();
+      program.setInt("vertexCompact", group.format == Eng::Vbo::Format::compact);
+      program.setUInt("firstDraw", group.first);
+      Eng::Arena::getInstance().render(static_cast<uint32_t>(group.format));
+      glMultiDrawElementsIndirect(GL_TRIANGLES, group.indexType, reinterpret_cast<void *>(group.first * sizeof(DrawCommand)), 
+                                  static_cast<GLsizei>(group.nrOfDraws), 0);
    }
+   glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+   program.setInt("multiDraw", 0);
 
    // Done:
    return true;
@@ -242,5 +1258,5 @@ bool ENG_API Eng::List::render(const glm::mat4 &cameraMatrix, const glm::mat4 &p
  */
 bool ENG_API Eng::List::render(const Eng::Camera &camera, Eng::List::Pass pass) const
 {   
-   return this->render(glm::inverse(camera.getWorldMatrix()), camera.getProjMatrix());
+   return this->render(Eng::Math::inverse(camera.getWorldMatrix()), camera.getProjMatrix(), pass);
 }
@@ -32,6 +32,7 @@ public: //
       all,      
       lights,
       meshes,      
+      casters,    ///< Meshes rendered as shadow casters (with their own visibility)
 
       // Terminator:
       last
@@ -45,12 +46,13 @@ public: //
    {
       std::reference_wrapper<const Eng::Object> reference;  ///< Reference to the original object
       glm::mat4 matrix;                                     ///< Final position in world coordinates     
+      uint32_t lod;                                         ///< Level of detail to render (meshes only)
 
 
       /**
        * Constructor. 
        */
-      RenderableElem() : reference{ Eng::Object::empty }, matrix{ 1.0f }
+      RenderableElem() : reference{ Eng::Object::empty }, matrix{ 1.0f }, lod{ 0 }
       {}
    };
 
@@ -66,6 +68,24 @@ public: //
    const Eng::List::RenderableElem &getRenderableElem(uint32_t elemNr) const;
    uint32_t getNrOfRenderableElems() const;
    uint32_t getNrOfLights() const;
+
+   // Level of detail:
+   bool setLodThresholds(const std::vector<float> &thresholds, float hysteresis = 0.1f);
+   const std::vector<float> &getLodThresholds() const;
+   float getLodHysteresis() const;
+   void setLodViewpoint(const Eng::Camera &camera);
+
+   // Culling:
+   void setSubtreeCulling(const glm::mat4 &viewProjectionMatrix);
+   void setSubtreeCulling(const glm::vec3 &position, float range);
+   void disableSubtreeCulling();
+   bool cull(const glm::mat4 &viewProjectionMatrix, Pass pass = Pass::meshes) const;
+   bool cull(const std::vector<glm::mat4> &viewProjectionMatrices, Pass pass) const;
+   bool isVisible(uint32_t elemNr, Pass pass = Pass::meshes) const;
+
+   // Multi-draw:
+   void setMultiDraw(bool flag);
+   bool isMultiDraw() const;
      
    // Scene graph traversal:
    void reset();
@@ -87,6 +107,9 @@ private: //
    // Const/dest:
    List(const std::string &name);
 
+   // Rendering:
+   bool renderMultiDraw(const glm::mat4 &cameraMatrix, Pass pass) const;
+
    // Workaround for disabling the unneeded rendering method:
    using Object::render;
 };
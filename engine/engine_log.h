@@ -25,7 +25,7 @@
 
 
 /**
- * @brief Logging facilities. Static components are lazy-loaded at first usage. Beware that it is not thread-safe yet.
+ * @brief Logging facilities. Static components are lazy-loaded at first usage. Messages can be logged concurrently once initialized.
  */
 class ENG_API Log final
 {
@@ -14,38 +14,116 @@
    // Main include:
    #include "engine.h"
 
+   // C/C++:
+   #include <typeinfo>
+#ifdef __GNUG__
+   #include <cxxabi.h>
+#endif
+
    // OGL:      
    #include <GL/glew.h>
    #include <GLFW/glfw3.h>
 
 
 
-////////////
-// STATIC //
-////////////
-
-   // Keep track of created instances:
-   std::list<std::reference_wrapper<Eng::Managed>> allManaged;
-
-
-
 /////////////////////////
 // RESERVED STRUCTURES //
 /////////////////////////
 
 /**
- * @brief Managed reserved structure.
+ * @brief Managed reserved structure. Initialized objects are kept in an intrusive doubly-linked list going through 
+ *        their reserved structures (which follow the objects when moved), so that registering, unregistering and 
+ *        moving an object take constant time.
  */
-struct Eng::Managed::Reserved
+struct Eng::Managed::Reserved : Eng::Pooled<Eng::Managed::Reserved>
 {  
-   bool initialized;    ///< True when the object is allocated on the device 
+   /**
+    * @brief Number of registered objects of a given type.
+    */
+   struct TypeCount
+   {
+      const std::type_info *info;   ///< Type
+      uint64_t count;               ///< Nr. of registered objects
+   };
+
+   // Consts:
+   static constexpr uint32_t maxNrOfTypes = 32;    ///< Types tracked separately (the others share the last entry)
+
+   bool initialized;       ///< True when the object is allocated on the device 
+   bool registered;        ///< True when in the list of the initialized objects
+   Eng::Managed *owner;    ///< Object owning this structure
+   Reserved *prev;         ///< Previous registered object
+   Reserved *next;         ///< Next registered object
+   uint32_t type;          ///< Entry in the type counts
+
+   // Registry (constant-initialized, as objects can be released by static destructors):
+   static inline Reserved *first = nullptr;                 ///< First (oldest) registered object
+   static inline Reserved *last = nullptr;                  ///< Last registered object
+   static inline uint64_t nrOfRegistered = 0;               ///< Nr. of registered objects
+   static inline TypeCount typeCounts[maxNrOfTypes] = {};   ///< Per type counts
+   static inline uint32_t nrOfTypes = 0;                    ///< Used entries of typeCounts
 
 
    /**
     * Constructor.
     */
-   Reserved() : initialized{ false }
+   Reserved() : initialized{ false }, registered{ false }, owner{ nullptr }, prev{ nullptr }, next{ nullptr }, type{ 0 }
    {}
+
+
+   /**
+    * Appends this object to the registry.
+    * @param obj owner object
+    */
+   void link(Eng::Managed &obj)
+   {
+      owner = &obj;
+      prev = last;
+      next = nullptr;
+      if (last)
+         last->next = this;
+      else
+         first = this;
+      last = this;
+      registered = true;
+      nrOfRegistered++;
+
+      // Count per type:
+      const std::type_info &info = typeid(obj);
+      for (type = 0; type < nrOfTypes; type++)
+         if (*typeCounts[type].info == info)
+            break;
+      if (type == nrOfTypes)
+      {
+         if (nrOfTypes < maxNrOfTypes)
+            typeCounts[nrOfTypes++] = { &info, 0 };
+         else
+            type = maxNrOfTypes - 1;
+      }
+      typeCounts[type].count++;
+   }
+
+
+   /**
+    * Removes this object from the registry.
+    */
+   void unlink()
+   {
+      if (!registered)
+         return;
+      if (prev)
+         prev->next = next;
+      else
+         first = next;
+      if (next)
+         next->prev = prev;
+      else
+         last = prev;
+      prev = next = nullptr;
+      registered = false;
+      nrOfRegistered--;
+      typeCounts[type].count--;
+   }
 };
 
 
@@ -73,12 +151,8 @@ ENG_API Eng::Managed::Managed(Managed &&other) : reserved(std::move(other.reserv
    ENG_LOG_DETAIL("[M]");
 
    // Update the reference:
-   for (auto it = allManaged.begin(); it != allManaged.end(); ++it)
-      if (it->get().reserved == other.reserved)
-      {
-         *it = *this; 
-         break;
-      }
+   if (reserved)
+      reserved->owner = this;
 }
 
 
@@ -90,13 +164,8 @@ ENG_API Eng::Managed::~Managed()
 {
    ENG_LOG_DETAIL("[-]");
 
-   if (!allManaged.empty())
-      for (auto it = allManaged.begin(); it != allManaged.end(); ++it)
-         if (it->get().reserved == this->reserved)
-         {  
-            allManaged.erase(it); // Already done in free
-            break;
-         }
+   if (reserved) // Already done in free, unless never called
+      reserved->unlink();
 }
 
 
@@ -115,7 +184,7 @@ bool ENG_API Eng::Managed::init()
    }
 
    // Add to the list:
-   allManaged.push_back(*this);
+   reserved->link(*this);
 
    // Done:
    reserved->initialized = true;
@@ -140,13 +209,7 @@ bool ENG_API Eng::Managed::free()
    }
    
    // Remove from list:
-   if (!allManaged.empty())
-      for (auto it = allManaged.begin(); it != allManaged.end(); ++it)
-         if (it->get().reserved == this->reserved)
-         {
-            allManaged.erase(it);
-            break;
-         }   
+   reserved->unlink();
 
    // Done:
    reserved->initialized = false;
@@ -163,24 +226,15 @@ bool ENG_API Eng::Managed::forceRelease()
 {
    ENG_LOG_DEBUG("Forced release of managed objects...");
 
-   uint64_t total = 0, initialized = 0;
-   if (!allManaged.empty())
+   // Always release the oldest object (releasing an object can release others as well):
+   uint64_t total = Reserved::nrOfRegistered, initialized = 0;
+   while (Reserved::first)
    {
-      auto it = allManaged.begin();
-      while (it != allManaged.end()) 
-      {
-         total++;
-         bool isInitialized = it->get().isInitialized();
-         if (isInitialized)
-         {
-            initialized++;
-            auto _it = it;            
-            it++;            
-            _it->get().free();
-         }
-         else
-            ++it;         
-      }
+      Reserved *r = Reserved::first;
+      if (r->initialized)
+         initialized++;
+      r->owner->free();
+      r->unlink(); // In case free() has been overridden without releasing the base class
    }
 
    // Done:
@@ -191,21 +245,32 @@ bool ENG_API Eng::Managed::forceRelease()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Passes the list and forces resource deallocation.
- * @return TF
+ * Prints the number of initialized objects, per type.
  */
 void ENG_API Eng::Managed::dumpReport()
 {
-   uint64_t total = 0, initialized = 0;
-   for (auto &m : allManaged)
+   ENG_LOG_PLAIN("%llu managed object(s) initialized", Reserved::nrOfRegistered);
+   for (uint32_t c = 0; c < Reserved::nrOfTypes; c++)
    {
-      total++;
-      if (m.get().isInitialized())
-         initialized++;           
+      if (Reserved::typeCounts[c].count == 0)
+         continue;
+
+      // Readable type name:
+      std::string name = Reserved::typeCounts[c].info->name();
+#ifdef __GNUG__
+      int status = 0;
+      char *demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+      if (demangled)
+      {
+         name = demangled;
+         std::free(demangled);
+      }
+#endif
+      for (const char *prefix : { "class ", "struct " })
+         if (name.compare(0, strlen(prefix), prefix) == 0)
+            name.erase(0, strlen(prefix));
+      ENG_LOG_PLAIN("   %s: %llu", name.c_str(), Reserved::typeCounts[c].count);
    }
-
-   // Done:
-   ENG_LOG_PLAIN("%llu managed object(s), %llu initialized", total, initialized); 
 }
 
 
@@ -32,7 +32,7 @@
 /**
  * @brief Material reserved structure.
  */
-struct Eng::Material::Reserved
+struct Eng::Material::Reserved : Eng::Pooled<Eng::Material::Reserved>
 {
    // Keep these vars first and in this order...:
    glm::vec3 emission;                                   ///< Emissive term
@@ -45,6 +45,9 @@ struct Eng::Material::Reserved
 
    std::reference_wrapper<const Eng::Texture> texture[Eng::Material::maxNrOfTextures];
 
+   // Bitmaps loaded by loadChunk(), waiting for upload():
+   std::vector<std::pair<Eng::Texture::Type, Eng::Bitmap>> pendingBitmaps;
+
 
    /**
     * Constructor.
@@ -71,6 +74,7 @@ struct Eng::Material::Reserved
 ENG_API Eng::Material::Material() : reserved(std::make_unique<Eng::Material::Reserved>())
 {
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -82,6 +86,7 @@ ENG_API Eng::Material::Material() : reserved(std::make_unique<Eng::Material::Res
 ENG_API Eng::Material::Material(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Material::Reserved>())
 {
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -92,6 +97,7 @@ ENG_API Eng::Material::Material(const std::string &name) : Eng::Object(name), re
 ENG_API Eng::Material::Material(Material &&other) : Eng::Object(std::move(other)), reserved(std::move(other.reserved))
 {
    ENG_LOG_DETAIL("[M]");
+   typeTags = tags;
 }
 
 
@@ -272,7 +278,7 @@ const Eng::Texture ENG_API &Eng::Material::getTexture(Eng::Texture::Type type) c
 /**
  * Loads the specific information of a given object. In its base class, this function loads the file version chunk.
  * @param serializer serial data
- * @param data optional pointer
+ * @param data optional pointer to an Ovo::Mode (immediate if nullptr)
  * @return 1 on success, 0 if error
  */
 uint32_t ENG_API Eng::Material::loadChunk(Eng::Serializer &serial, void *data)
@@ -300,86 +306,95 @@ uint32_t ENG_API Eng::Material::loadChunk(Eng::Serializer &serial, void *data)
    serial.deserialize(reserved->metalness);
    serial.deserialize(reserved->opacity);
 
-   // Textures:
-   Eng::Container &container = Eng::Container::getInstance();
-
-   // Albedo:
-   serial.deserialize(name); 
-   ENG_LOG_PLAIN("Texture (albedo): %s", name.c_str());
-   if (name != "[none]")
+   // Textures (height is ignored):
+   const struct
    {
-      Eng::Bitmap bitmap;
-      if (!bitmap.load(name))
-         ENG_LOG_ERROR("Unable to load image file '%s'", name.c_str());
-      else
-      {
-         Eng::Texture tex;
-         tex.load(bitmap);
-         container.add(tex);     
-         this->setTexture(container.getLastTexture(), Eng::Texture::Type::albedo);
-      }
-   }
-
-   // Normal:
-   serial.deserialize(name); 
-   ENG_LOG_PLAIN("Texture (normal): %s", name.c_str());
-   if (name != "[none]")
+      const char *label;
+      Eng::Texture::Type type;
+   } levels[] = { { "albedo", Eng::Texture::Type::albedo },
+                  { "normal", Eng::Texture::Type::normal },
+                  { "height", Eng::Texture::Type::none },
+                  { "roughness", Eng::Texture::Type::roughness },
+                  { "metalness", Eng::Texture::Type::metalness } };
+
+   for (auto &level : levels)
    {
+      serial.deserialize(name);
+      ENG_LOG_PLAIN("Texture (%s): %s", level.label, name.c_str());
+      if (name == "[none]" || level.type == Eng::Texture::Type::none)
+         continue;
+
       Eng::Bitmap bitmap;
       if (!bitmap.load(name))
          ENG_LOG_ERROR("Unable to load image file '%s'", name.c_str());
       else
-      {
-         container.add(bitmap);
-         Eng::Texture tex;
-         tex.load(container.getLastBitmap());
-         container.add(tex);     
-         this->setTexture(container.getLastTexture(), Eng::Texture::Type::normal);
-      }
+         reserved->pendingBitmaps.emplace_back(level.type, std::move(bitmap));
    }
 
-   // Height (ignored):
-   serial.deserialize(name); 
-   ENG_LOG_PLAIN("Texture (height): %s", name.c_str());
-   
-   // Roughness:
-   serial.deserialize(name); 
-   ENG_LOG_PLAIN("Texture (roughness): %s", name.c_str());
-   if (name != "[none]")
+   // Create GPU resources now, unless deferred:
+   if (data == nullptr || *static_cast<Eng::Ovo::Mode *>(data) != Eng::Ovo::Mode::deferred)
+      upload();
+
+   // Done:
+   return 1;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Saves the specific information of a given object as a new chunk. Textures are referenced by their file name.
+ * @param serial serial data
+ * @return TF
+ */
+bool ENG_API Eng::Material::saveChunk(Eng::Serializer &serial) const
+{
+   const uint64_t start = beginChunk(serial, Ovo::ChunkId::material);
+
+   // Material properties:
+   serial.serialize(this->getName());
+
+   // PBR props:
+   serial.serialize(reserved->emission);
+   serial.serialize(reserved->albedo);
+   serial.serialize(reserved->roughness);
+   serial.serialize(reserved->metalness);
+   serial.serialize(reserved->opacity);
+
+   // Textures (same order as in loadChunk(), height is never set):
+   const Eng::Texture::Type levels[] = { Eng::Texture::Type::albedo, Eng::Texture::Type::normal, Eng::Texture::Type::none,
+                                         Eng::Texture::Type::roughness, Eng::Texture::Type::metalness };
+   for (auto level : levels)
    {
-      Eng::Bitmap bitmap;
-      if (!bitmap.load(name))
-         ENG_LOG_ERROR("Unable to load image file '%s'", name.c_str());
-      else
-      {
-         container.add(bitmap);
-         Eng::Texture tex;
-         tex.load(container.getLastBitmap());
-         container.add(tex);     
-         this->setTexture(container.getLastTexture(), Eng::Texture::Type::roughness);
-      }
+      const Eng::Texture &tex = (level == Eng::Texture::Type::none) ? Eng::Texture::empty : this->getTexture(level);
+      serial.serialize((tex == Eng::Texture::empty) ? std::string("[none]") : tex.getName());
    }
 
-   // Metalness:
-   serial.deserialize(name); 
-   ENG_LOG_PLAIN("Texture (metalness): %s", name.c_str());
-   if (name != "[none]")
+   // Done:
+   return endChunk(serial, start);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Creates the textures of the bitmaps loaded by loadChunk(). Must be called from the main thread.
+ * @return TF
+ */
+bool ENG_API Eng::Material::upload()
+{
+   Eng::Container &container = Eng::Container::getInstance();
+   for (auto &pending : reserved->pendingBitmaps)
    {
-      Eng::Bitmap bitmap;
-      if (!bitmap.load(name))
-         ENG_LOG_ERROR("Unable to load image file '%s'", name.c_str());
-      else
-      {
-         container.add(bitmap);
-         Eng::Texture tex;
-         tex.load(container.getLastBitmap());
-         container.add(tex);     
-         this->setTexture(container.getLastTexture(), Eng::Texture::Type::metalness);
-      }
-   }   
+      container.add(pending.second);
+      Eng::Texture tex;
+      tex.load(container.getLastBitmap());
+      tex.setName(container.getLastBitmap().getName()); // Keeps the file name, for saving
+      container.add(tex);
+      this->setTexture(container.getLastTexture(), pending.first);
+   }
+   reserved->pendingBitmaps.clear();
 
    // Done:
-   return 1;
+   return true;
 }
 
 
@@ -19,6 +19,9 @@ public: //
 
    // Special values:
    static Material empty;
+
+   // Type tags:
+   static constexpr uint32_t tags = Eng::Object::tags | static_cast<uint32_t>(Tag::material);
    constexpr static uint32_t maxNrOfTextures = 4;     ///< Max number of textures per material
    
 
@@ -47,6 +50,8 @@ public: //
 
    // Ovo:   
    uint32_t loadChunk(Eng::Serializer &serial, void *data = nullptr) override;
+   bool saveChunk(Eng::Serializer &serial) const override;
+   bool upload() override;
 
 
 ///////////
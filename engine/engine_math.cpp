@@ -0,0 +1,507 @@
+/**
+ * @file		engine_math.cpp
+ * @brief	Batch matrix kernels
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // SIMD (SSE2 is the baseline of any x86-64 CPU, AVX2 is detected at runtime and enabled per function):
+#if defined(__SSE2__) || defined(_M_X64)
+   #define ENG_MATH_SSE
+   #include <immintrin.h>
+   #ifdef _MSC_VER
+      #include <intrin.h>
+      #define ENG_MATH_AVX2
+   #else
+      #define ENG_MATH_AVX2 __attribute__((target("avx2,fma")))
+   #endif
+#endif
+
+
+
+////////////
+// STATIC //
+////////////
+
+#ifdef ENG_MATH_SSE
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Cross product of the xyz components (w is left to 0 when both inputs have w = 0).
+ * @param a first vector
+ * @param b second vector
+ * @return a x b
+ */
+static inline __m128 cross(__m128 a, __m128 b)
+{
+   const __m128 aYzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+   const __m128 bYzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+   const __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYzx), _mm_mul_ps(aYzx, b));
+   return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Dot product of the xyz components, broadcast to all the lanes.
+ * @param a first vector (w = 0)
+ * @param b second vector (w = 0)
+ * @return a . b
+ */
+static inline __m128 dot3(__m128 a, __m128 b)
+{
+   const __m128 m = _mm_mul_ps(a, b);
+   const __m128 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+   return _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Same as cross(), on two pairs of vectors at once (one pair per 128-bit lane).
+ * @param a first vectors
+ * @param b second vectors
+ * @return a x b, per lane
+ */
+static inline ENG_MATH_AVX2 __m256 cross2(__m256 a, __m256 b)
+{
+   const __m256 aYzx = _mm256_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+   const __m256 bYzx = _mm256_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+   const __m256 c = _mm256_fmsub_ps(a, bYzx, _mm256_mul_ps(aYzx, b));
+   return _mm256_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Same as dot3(), on two pairs of vectors at once (one pair per 128-bit lane).
+ * @param a first vectors (w = 0)
+ * @param b second vectors (w = 0)
+ * @return a . b, broadcast within each lane
+ */
+static inline ENG_MATH_AVX2 __m256 dot3x2(__m256 a, __m256 b)
+{
+   const __m256 m = _mm256_mul_ps(a, b);
+   const __m256 s = _mm256_add_ps(m, _mm256_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+   return _mm256_add_ps(s, _mm256_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Loads the same column of two matrices, the first one in the low lane and the second one in the high lane.
+ * @param a column of the first matrix
+ * @param b column of the second matrix
+ * @return both columns
+ */
+static inline ENG_MATH_AVX2 __m256 loadColumns(const float *a, const float *b)
+{
+   return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(a)), _mm_loadu_ps(b), 1);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Stores the two halves of a register as the same column of two matrices.
+ * @param a column of the first matrix
+ * @param b column of the second matrix
+ * @param columns both columns
+ */
+static inline ENG_MATH_AVX2 void storeColumns(float *a, float *b, __m256 columns)
+{
+   _mm_storeu_ps(a, _mm256_castps256_ps128(columns));
+   _mm_storeu_ps(b, _mm256_extractf128_ps(columns, 1));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * SSE2 version of Math::multiply().
+ * @param left matrix on the left side of each product
+ * @param src first right side matrix
+ * @param dst first resulting matrix
+ * @param count number of matrices
+ * @param rightStride distance between two right side matrices, in bytes
+ * @param resultStride distance between two resulting matrices, in bytes
+ */
+static void multiplySse2(const glm::mat4 &left, const uint8_t *src, uint8_t *dst, uint64_t count, uint64_t rightStride, uint64_t resultStride)
+{
+   const __m128 l0 = _mm_loadu_ps(glm::value_ptr(left[0]));
+   const __m128 l1 = _mm_loadu_ps(glm::value_ptr(left[1]));
+   const __m128 l2 = _mm_loadu_ps(glm::value_ptr(left[2]));
+   const __m128 l3 = _mm_loadu_ps(glm::value_ptr(left[3]));
+   for (uint64_t c = 0; c < count; c++, src += rightStride, dst += resultStride)
+   {
+      const float *r = reinterpret_cast<const float *>(src);
+      __m128 columns[4];
+      for (uint32_t j = 0; j < 4; j++, r += 4)
+         columns[j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l0, _mm_set1_ps(r[0])), _mm_mul_ps(l1, _mm_set1_ps(r[1]))),
+                                 _mm_add_ps(_mm_mul_ps(l2, _mm_set1_ps(r[2])), _mm_mul_ps(l3, _mm_set1_ps(r[3]))));
+      float *d = reinterpret_cast<float *>(dst);
+      for (uint32_t j = 0; j < 4; j++)
+         _mm_storeu_ps(d + j * 4, columns[j]);
+   }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * AVX2 version of Math::multiply(), two matrices at a time. The last matrix is left over when the count is odd.
+ * @param left matrix on the left side of each product
+ * @param src first right side matrix
+ * @param dst first resulting matrix
+ * @param count number of matrices
+ * @param rightStride distance between two right side matrices, in bytes
+ * @param resultStride distance between two resulting matrices, in bytes
+ * @return number of matrices processed
+ */
+static ENG_MATH_AVX2 uint64_t multiplyAvx2(const glm::mat4 &left, const uint8_t *src, uint8_t *dst, uint64_t count, uint64_t rightStride, uint64_t resultStride)
+{
+   const __m256 l0 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(glm::value_ptr(left[0])));
+   const __m256 l1 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(glm::value_ptr(left[1])));
+   const __m256 l2 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(glm::value_ptr(left[2])));
+   const __m256 l3 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(glm::value_ptr(left[3])));
+   const uint64_t nrOfPairs = count / 2;
+   for (uint64_t c = 0; c < nrOfPairs; c++, src += 2 * rightStride, dst += 2 * resultStride)
+   {
+      const float *a = reinterpret_cast<const float *>(src);
+      const float *b = reinterpret_cast<const float *>(src + rightStride);
+      __m256 columns[4];
+      for (uint32_t j = 0; j < 4; j++)
+      {
+         const __m256 r = loadColumns(a + j * 4, b + j * 4);
+         const __m256 column = _mm256_fmadd_ps(l1, _mm256_permute_ps(r, _MM_SHUFFLE(1, 1, 1, 1)), _mm256_mul_ps(l0, _mm256_permute_ps(r, _MM_SHUFFLE(0, 0, 0, 0))));
+         columns[j] = _mm256_fmadd_ps(l3, _mm256_permute_ps(r, _MM_SHUFFLE(3, 3, 3, 3)), _mm256_fmadd_ps(l2, _mm256_permute_ps(r, _MM_SHUFFLE(2, 2, 2, 2)), column));
+      }
+      float *da = reinterpret_cast<float *>(dst);
+      float *db = reinterpret_cast<float *>(dst + resultStride);
+      for (uint32_t j = 0; j < 4; j++)
+         storeColumns(da + j * 4, db + j * 4, columns[j]);
+   }
+
+   // Done:
+   return nrOfPairs * 2;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * SSE2 version of Math::normalMatrix().
+ * @param src first input matrix
+ * @param dst first resulting matrix
+ * @param count number of matrices
+ * @param stride distance between two input matrices, in bytes
+ * @param resultStride distance between two resulting matrices, in bytes
+ */
+static void normalMatrixSse2(const uint8_t *src, uint8_t *dst, uint64_t count, uint64_t stride, uint64_t resultStride)
+{
+   const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+   const __m128 lastColumn = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+   for (uint64_t c = 0; c < count; c++, src += stride, dst += resultStride)
+   {
+      const float *m = reinterpret_cast<const float *>(src);
+      const __m128 a = _mm_and_ps(_mm_loadu_ps(m), xyzMask);
+      const __m128 b = _mm_and_ps(_mm_loadu_ps(m + 4), xyzMask);
+      const __m128 d = _mm_and_ps(_mm_loadu_ps(m + 8), xyzMask);
+      const __m128 bd = cross(b, d);
+      const __m128 da = cross(d, a);
+      const __m128 ab = cross(a, b);
+      const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), dot3(a, bd));
+      float *r = reinterpret_cast<float *>(dst);
+      _mm_storeu_ps(r, _mm_mul_ps(bd, invDet));
+      _mm_storeu_ps(r + 4, _mm_mul_ps(da, invDet));
+      _mm_storeu_ps(r + 8, _mm_mul_ps(ab, invDet));
+      _mm_storeu_ps(r + 12, lastColumn);
+   }
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * AVX2 version of Math::normalMatrix(), two matrices at a time. The last matrix is left over when the count is odd.
+ * @param src first input matrix
+ * @param dst first resulting matrix
+ * @param count number of matrices
+ * @param stride distance between two input matrices, in bytes
+ * @param resultStride distance between two resulting matrices, in bytes
+ * @return number of matrices processed
+ */
+static ENG_MATH_AVX2 uint64_t normalMatrixAvx2(const uint8_t *src, uint8_t *dst, uint64_t count, uint64_t stride, uint64_t resultStride)
+{
+   const __m256 xyzMask = _mm256_castsi256_ps(_mm256_set_epi32(0, -1, -1, -1, 0, -1, -1, -1));
+   const __m128 lastColumn = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+   const uint64_t nrOfPairs = count / 2;
+   for (uint64_t c = 0; c < nrOfPairs; c++, src += 2 * stride, dst += 2 * resultStride)
+   {
+      const float *ma = reinterpret_cast<const float *>(src);
+      const float *mb = reinterpret_cast<const float *>(src + stride);
+      const __m256 a = _mm256_and_ps(loadColumns(ma, mb), xyzMask);
+      const __m256 b = _mm256_and_ps(loadColumns(ma + 4, mb + 4), xyzMask);
+      const __m256 d = _mm256_and_ps(loadColumns(ma + 8, mb + 8), xyzMask);
+      const __m256 bd = cross2(b, d);
+      const __m256 da = cross2(d, a);
+      const __m256 ab = cross2(a, b);
+      const __m256 invDet = _mm256_div_ps(_mm256_set1_ps(1.0f), dot3x2(a, bd));
+      float *ra = reinterpret_cast<float *>(dst);
+      float *rb = reinterpret_cast<float *>(dst + resultStride);
+      storeColumns(ra, rb, _mm256_mul_ps(bd, invDet));
+      storeColumns(ra + 4, rb + 4, _mm256_mul_ps(da, invDet));
+      storeColumns(ra + 8, rb + 8, _mm256_mul_ps(ab, invDet));
+      _mm_storeu_ps(ra + 12, lastColumn);
+      _mm_storeu_ps(rb + 12, lastColumn);
+   }
+
+   // Done:
+   return nrOfPairs * 2;
+}
+#endif
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Detects the best instruction set available for the kernels.
+ * @return instruction set
+ */
+static Eng::Math::Simd detectSimd()
+{
+#ifdef ENG_MATH_SSE
+   #ifdef _MSC_VER
+      int info[4];
+      __cpuid(info, 0);
+      const int maxLeaf = info[0];
+      __cpuid(info, 1);
+      const bool fma = (info[2] & (1 << 12)) != 0;
+      const bool osxsave = (info[2] & (1 << 27)) != 0;
+      const bool avx = (info[2] & (1 << 28)) != 0;
+      bool avx2 = false;
+      if (maxLeaf >= 7)
+      {
+         __cpuidex(info, 7, 0);
+         avx2 = (info[1] & (1 << 5)) != 0;
+      }
+      if (fma && osxsave && avx && avx2 && (_xgetbv(0) & 0x6) == 0x6) // YMM state enabled by the OS
+         return Eng::Math::Simd::avx2;
+   #else
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) // Also checks the OS support
+         return Eng::Math::Simd::avx2;
+   #endif
+   return Eng::Math::Simd::sse2;
+#else
+   return Eng::Math::Simd::none;
+#endif
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the instruction set currently used by the kernels.
+ * @return instruction set reference
+ */
+static Eng::Math::Simd &currentSimd()
+{
+   static Eng::Math::Simd simd = Eng::Math::getSupportedSimd();
+   return simd;
+}
+
+
+
+////////////////////////
+// BODY OF CLASS Math //
+////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the best instruction set supported by both the build and the CPU (detected once).
+ * @return instruction set
+ */
+Eng::Math::Simd ENG_API Eng::Math::getSupportedSimd()
+{
+   static const Simd simd = detectSimd();
+   return simd;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the instruction set used by the kernels (the best supported one, unless changed with setSimd()).
+ * @return instruction set
+ */
+Eng::Math::Simd ENG_API Eng::Math::getSimd()
+{
+   return currentSimd();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Restricts the kernels to a given instruction set (e.g., to compare the paths). Not thread-safe: to be called while
+ * no kernel is running.
+ * @param simd instruction set, up to getSupportedSimd()
+ * @return TF
+ */
+bool ENG_API Eng::Math::setSimd(Simd simd)
+{
+   // Safety net:
+   if (simd == Simd::last || static_cast<uint32_t>(simd) > static_cast<uint32_t>(getSupportedSimd()))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   currentSimd() = simd;
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Multiplies one matrix by an array of matrices (e.g., the camera matrix by the world matrices of a render list).
+ * @param left matrix on the left side of each product
+ * @param right first matrix of the right side
+ * @param result first resulting matrix (can alias the right side)
+ * @param count number of matrices
+ * @param rightStride distance between two right side matrices, in bytes
+ * @param resultStride distance between two resulting matrices, in bytes
+ * @return TF
+ */
+bool ENG_API Eng::Math::multiply(const glm::mat4 &left, const glm::mat4 *right, glm::mat4 *result, uint64_t count, uint64_t rightStride, uint64_t resultStride)
+{
+   // Safety net:
+   if (count && (right == nullptr || result == nullptr))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   const uint8_t *src = reinterpret_cast<const uint8_t *>(right);
+   uint8_t *dst = reinterpret_cast<uint8_t *>(result);
+
+#ifdef ENG_MATH_SSE
+   const Simd simd = currentSimd();
+   if (simd == Simd::avx2)
+   {
+      const uint64_t done = multiplyAvx2(left, src, dst, count, rightStride, resultStride);
+      src += done * rightStride;
+      dst += done * resultStride;
+      count -= done;
+   }
+   if (simd != Simd::none)
+   {
+      multiplySse2(left, src, dst, count, rightStride, resultStride);
+      return true;
+   }
+#endif
+
+   for (uint64_t c = 0; c < count; c++, src += rightStride, dst += resultStride)
+      *reinterpret_cast<glm::mat4 *>(dst) = left * *reinterpret_cast<const glm::mat4 *>(src);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Computes the normal matrices (inverse transpose of the upper 3x3 part) of an array of matrices. Results are stored
+ * as 4x4 matrices, as glm::mat4(glm::mat3) does. The inverse transpose is built from cross products of the columns,
+ * without a full inversion.
+ * @param matrices first matrix
+ * @param result first resulting matrix (can alias the input)
+ * @param count number of matrices
+ * @param stride distance between two input matrices, in bytes
+ * @param resultStride distance between two resulting matrices, in bytes
+ * @return TF
+ */
+bool ENG_API Eng::Math::normalMatrix(const glm::mat4 *matrices, glm::mat4 *result, uint64_t count, uint64_t stride, uint64_t resultStride)
+{
+   // Safety net:
+   if (count && (matrices == nullptr || result == nullptr))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   const uint8_t *src = reinterpret_cast<const uint8_t *>(matrices);
+   uint8_t *dst = reinterpret_cast<uint8_t *>(result);
+
+#ifdef ENG_MATH_SSE
+   const Simd simd = currentSimd();
+   if (simd == Simd::avx2)
+   {
+      const uint64_t done = normalMatrixAvx2(src, dst, count, stride, resultStride);
+      src += done * stride;
+      dst += done * resultStride;
+      count -= done;
+   }
+   if (simd != Simd::none)
+   {
+      normalMatrixSse2(src, dst, count, stride, resultStride);
+      return true;
+   }
+#endif
+
+   for (uint64_t c = 0; c < count; c++, src += stride, dst += resultStride)
+      *reinterpret_cast<glm::mat4 *>(dst) = glm::mat4(normalMatrix(*reinterpret_cast<const glm::mat4 *>(src)));
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Computes the normal matrix (inverse transpose of the upper 3x3 part) of a matrix.
+ * @param matrix input matrix
+ * @return normal matrix
+ */
+glm::mat3 ENG_API Eng::Math::normalMatrix(const glm::mat4 &matrix)
+{
+   const glm::vec3 a = glm::vec3(matrix[0]);
+   const glm::vec3 b = glm::vec3(matrix[1]);
+   const glm::vec3 d = glm::vec3(matrix[2]);
+   const glm::vec3 bd = glm::cross(b, d);
+   const float invDet = 1.0f / glm::dot(a, bd);
+   return glm::mat3(bd * invDet, glm::cross(d, a) * invDet, glm::cross(a, b) * invDet);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether a matrix is affine (last row equal to 0, 0, 0, 1), as model, view and light matrices are.
+ * @param matrix input matrix
+ * @return true if affine, false otherwise
+ */
+bool ENG_API Eng::Math::isAffine(const glm::mat4 &matrix)
+{
+   return matrix[0][3] == 0.0f && matrix[1][3] == 0.0f && matrix[2][3] == 0.0f && matrix[3][3] == 1.0f;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Inverts a matrix. Affine matrices only need the inverse of their 3x3 part (and the translation is mapped through it),
+ * the others fall back to the generic glm::inverse().
+ * @param matrix input matrix
+ * @return inverse matrix
+ */
+glm::mat4 ENG_API Eng::Math::inverse(const glm::mat4 &matrix)
+{
+   if (!isAffine(matrix))
+      return glm::inverse(matrix);
+
+   const glm::mat3 inv = glm::transpose(normalMatrix(matrix));
+   glm::mat4 result = glm::mat4(inv);
+   result[3] = glm::vec4(-(inv * glm::vec3(matrix[3])), 1.0f);
+   return result;
+}
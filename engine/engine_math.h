@@ -0,0 +1,56 @@
+/**
+ * @file		engine_math.h
+ * @brief	Batch matrix kernels
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Matrix kernels working on whole arrays at once (e.g., all the elements of a render list). On x86-64 builds
+ *        (__SSE2__ or _M_X64 defined) the kernels use SSE2, or AVX2 (two matrices per register) when the CPU supports
+ *        it, as detected at runtime; other targets use a plain GLM path. Arrays are walked with a stride in bytes, so
+ *        that matrices can be read from and written to interleaved structures directly.
+ */
+class ENG_API Math final
+{
+//////////
+public: //
+//////////
+
+   /**
+    * @brief Instruction sets used by the batch kernels, from the least to the most capable.
+    */
+   enum class Simd : uint32_t
+   {
+      none,          ///< Plain GLM
+      sse2,          ///< One matrix column per register
+      avx2,          ///< Two matrix columns (of two matrices) per register
+
+      // Terminator:
+      last
+   };
+
+
+   // Const/dest:
+   Math() = delete;
+   ~Math() = delete;
+
+   // Instruction sets:
+   static Simd getSupportedSimd();
+   static Simd getSimd();
+   static bool setSimd(Simd simd);
+
+   // Batch kernels:
+   static bool multiply(const glm::mat4 &left, const glm::mat4 *right, glm::mat4 *result, uint64_t count,
+                        uint64_t rightStride = sizeof(glm::mat4), uint64_t resultStride = sizeof(glm::mat4));
+   static bool normalMatrix(const glm::mat4 *matrices, glm::mat4 *result, uint64_t count,
+                            uint64_t stride = sizeof(glm::mat4), uint64_t resultStride = sizeof(glm::mat4));
+
+   // Single matrix:
+   static glm::mat3 normalMatrix(const glm::mat4 &matrix);
+   static bool isAffine(const glm::mat4 &matrix);
+   static glm::mat4 inverse(const glm::mat4 &matrix);
+};
@@ -14,6 +14,14 @@
    // Main include:
    #include "engine.h"
 
+   // C/C++:
+   #include <algorithm>
+   #include <cmath>
+   #include <cstddef>
+   #include <limits>
+   #include <map>
+   #include <tuple>
+
    // GLM:
    #include <glm/gtc/packing.hpp>  
 
@@ -30,35 +38,401 @@
    // Special values:
    Eng::Mesh Eng::Mesh::empty("[empty]");
 
+   // Vertex cache models:
+   static constexpr uint32_t optimizerCacheSize = 32;    ///< LRU cache targeted by the triangle reordering
+   static constexpr uint32_t statsCacheSize = 16;        ///< FIFO cache used to measure ACMR/ATVR
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Simulates a FIFO post-transform vertex cache over an index list.
+ * @param indices triangle list
+ * @param nrOfVertices number of vertices referenced by the indices
+ * @param acmr average cache miss ratio (transformed vertices per triangle)
+ * @param atvr average transformed to vertex ratio (transformed vertices per referenced vertex)
+ */
+static void measureCache(const std::vector<uint32_t> &indices, uint32_t nrOfVertices, float &acmr, float &atvr)
+{
+   // A vertex is cached when less than statsCacheSize misses happened after its own:
+   std::vector<uint32_t> stamp(nrOfVertices, 0);
+   uint32_t misses = 0;
+   for (auto i : indices)
+      if (stamp[i] == 0 || misses - stamp[i] >= statsCacheSize)
+         stamp[i] = ++misses;
+
+   const uint32_t nrOfReferenced = static_cast<uint32_t>(nrOfVertices - std::count(stamp.begin(), stamp.end(), 0u));
+   acmr = indices.empty() ? 0.0f : static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+   atvr = nrOfReferenced ? static_cast<float>(misses) / static_cast<float>(nrOfReferenced) : 0.0f;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Forsyth's vertex score: vertices recently used and vertices with few triangles left are preferred.
+ * @param cachePosition position in the modeled LRU cache, -1 if not cached
+ * @param nrOfTriangles number of triangles still to emit using this vertex
+ * @return score
+ */
+static float vertexScore(int32_t cachePosition, uint32_t nrOfTriangles)
+{
+   if (nrOfTriangles == 0)
+      return -1.0f;
+
+   float score = 0.0f;
+   if (cachePosition >= 0)
+   {
+      if (cachePosition < 3) // Vertices of the last triangle, fixed to avoid favoring strips
+         score = 0.75f;
+      else
+         score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / static_cast<float>(optimizerCacheSize - 3), 1.5f);
+   }
+   return score + 2.0f / std::sqrt(static_cast<float>(nrOfTriangles));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reorders triangles for the post-transform vertex cache (Forsyth's linear-speed algorithm).
+ * @param indices triangle list, reordered in place
+ * @param nrOfVertices number of vertices referenced by the indices
+ */
+static void reorderTriangles(std::vector<uint32_t> &indices, uint32_t nrOfVertices)
+{
+   const uint32_t nrOfFaces = static_cast<uint32_t>(indices.size() / 3);
+
+   // Vertex to triangle adjacency (the first 'remaining' entries of each range are the triangles not emitted yet):
+   std::vector<uint32_t> remaining(nrOfVertices, 0);
+   for (auto i : indices)
+      remaining[i]++;
+   std::vector<uint32_t> offsets(nrOfVertices + 1, 0);
+   for (uint32_t v = 0; v < nrOfVertices; v++)
+      offsets[v + 1] = offsets[v] + remaining[v];
+   std::vector<uint32_t> adjacency(indices.size());
+   std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+   for (uint32_t f = 0; f < nrOfFaces; f++)
+      for (uint32_t k = 0; k < 3; k++)
+         adjacency[fill[indices[f * 3 + k]]++] = f;
+
+   // Initial scores:
+   std::vector<int32_t> cachePosition(nrOfVertices, -1);
+   std::vector<float> vScore(nrOfVertices);
+   for (uint32_t v = 0; v < nrOfVertices; v++)
+      vScore[v] = vertexScore(-1, remaining[v]);
+   std::vector<float> tScore(nrOfFaces);
+   std::vector<bool> emitted(nrOfFaces, false);
+   int64_t best = -1;
+   for (uint32_t f = 0; f < nrOfFaces; f++)
+   {
+      tScore[f] = vScore[indices[f * 3]] + vScore[indices[f * 3 + 1]] + vScore[indices[f * 3 + 2]];
+      if (best < 0 || tScore[f] > tScore[best])
+         best = f;
+   }
+
+   std::vector<uint32_t> output;
+   output.reserve(indices.size());
+   std::vector<uint32_t> cache, newCache;
+   cache.reserve(optimizerCacheSize + 3);
+   newCache.reserve(optimizerCacheSize + 3);
+   uint32_t cursor = 0;
+   for (uint32_t c = 0; c < nrOfFaces; c++)
+   {
+      // No candidate around the cache, take the next triangle left:
+      if (best < 0)
+      {
+         while (emitted[cursor])
+            cursor++;
+         best = cursor;
+      }
+
+      // Emit it:
+      const uint32_t *tri = &indices[best * 3];
+      emitted[best] = true;
+      newCache.assign(tri, tri + 3);
+      for (uint32_t k = 0; k < 3; k++)
+      {
+         output.push_back(tri[k]);
+
+         // Remove from the adjacency of its vertices:
+         const uint32_t v = tri[k];
+         uint32_t *begin = &adjacency[offsets[v]];
+         uint32_t *last = begin + remaining[v] - 1;
+         std::iter_swap(std::find(begin, last + 1, static_cast<uint32_t>(best)), last);
+         remaining[v]--;
+      }
+
+      // Update the LRU cache (it temporarily grows beyond its size, to refresh the evicted vertices too):
+      for (auto v : cache)
+         if (std::find(newCache.begin(), newCache.begin() + 3, v) == newCache.begin() + 3)
+            newCache.push_back(v);
+      for (uint32_t p = 0; p < newCache.size(); p++)
+      {
+         const uint32_t v = newCache[p];
+         cachePosition[v] = (p < optimizerCacheSize) ? static_cast<int32_t>(p) : -1;
+         vScore[v] = vertexScore(cachePosition[v], remaining[v]);
+      }
+
+      // Rescore the triangles touching the cache and pick the best one:
+      best = -1;
+      for (auto v : newCache)
+         for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; a++)
+         {
+            const uint32_t f = adjacency[a];
+            tScore[f] = vScore[indices[f * 3]] + vScore[indices[f * 3 + 1]] + vScore[indices[f * 3 + 2]];
+            if (best < 0 || tScore[f] > tScore[best])
+               best = f;
+         }
+
+      if (newCache.size() > optimizerCacheSize)
+         newCache.resize(optimizerCacheSize);
+      std::swap(cache, newCache);
+   }
+
+   indices.swap(output);
+}
+
 
 
 /////////////////////////
 // RESERVED STRUCTURES //
 /////////////////////////
 
+/**
+ * @brief Key identifying a geometry: hash of the vertices, hash of the faces, nr. of vertices, nr. of faces, layout.
+ */
+using GeometryKey = std::tuple<uint64_t, uint64_t, uint32_t, uint32_t, Eng::Vbo::Format>;
+
+
+/**
+ * @brief Range of the geometry arena used by a single level of detail, shared by all the meshes with the same geometry.
+ */
+struct Lod
+{
+   Eng::Arena::Allocation allocation;  ///< Vertices and indices within the arena
+   uint32_t id;                        ///< Unique geometry identifier
+   GeometryKey key;                    ///< Key of the geometry
+   bool cached;                        ///< True when listed in the geometry cache under its key
+
+
+   /**
+    * Constructor.
+    */
+   Lod() : id{ 0 }, cached{ false }
+   {}
+
+
+   /**
+    * Destructor.
+    */
+   ~Lod();
+};
+
+
+/**
+ * @brief Level of detail parsed by loadChunk() and waiting for upload() (pointers into the serialized data).
+ */
+struct PendingLod
+{
+   const void *vertices;
+   uint32_t nrOfVertices;
+   const void *faces;
+   uint32_t nrOfFaces;
+};
+
+
 /**
  * @brief Mesh class reserved structure.
  */
-struct Eng::Mesh::Reserved
+struct Eng::Mesh::Reserved : Eng::Pooled<Eng::Mesh::Reserved>
 {  
-   // Buffers:
-   Eng::Vao vao;
-   Eng::Vbo vbo;
-   Eng::Ebo ebo;
+   // Geometry (one arena range per LOD, 0 is the most detailed; shared with the meshes having the same geometry):
+   std::vector<std::shared_ptr<Lod>> lods;
+
+   // Bounding sphere radius:
+   float radius;
+
+   // Bounding box, in local coordinates (empty when min > max):
+   glm::vec3 bboxMin;
+   glm::vec3 bboxMax;
+
+   // Vertex layout of the LODs:
+   Eng::Vbo::Format format;
 
    // Material:
    std::reference_wrapper<const Eng::Material> material;
+
+   // Parsed data waiting for upload():
+   std::string pendingMaterial;
+   std::vector<PendingLod> pendingLods;
    
 
    /**
     * Constructor
     */
-   Reserved() : material{ Eng::Material::empty }
+   Reserved() : radius{ 0.0f }, bboxMin{ std::numeric_limits<float>::max() }, bboxMax{ -std::numeric_limits<float>::max() },
+                format{ Eng::Vbo::Format::standard }, material{ Eng::Material::empty }
    {}
 };
 
 
 
+////////////
+// STATIC //
+////////////
+
+   // Geometry identifier counter:
+   static uint32_t lastGeometryId = 0;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the geometry already on the GPU (weak references, ranges are released with the last mesh using them). The map 
+ * is never destroyed, as the meshes of static objects can still release their ranges after it.
+ * @return geometry cache reference
+ */
+static std::map<GeometryKey, std::weak_ptr<Lod>> &getGeometryCache()
+{
+   static std::map<GeometryKey, std::weak_ptr<Lod>> *cache = new std::map<GeometryKey, std::weak_ptr<Lod>>();
+   return *cache;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor. Releases the range and removes the geometry from the cache.
+ */
+Lod::~Lod()
+{
+   if (cached)
+      getGeometryCache().erase(key);
+   if (Eng::Arena::isAvailable())
+      Eng::Arena::getInstance().release(allocation);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Hashes a block of memory (64-bit FNV-1a).
+ * @param data pointer to the data
+ * @param nrOfBytes size of the data
+ * @return hash value
+ */
+static uint64_t hashBytes(const void *data, uint64_t nrOfBytes)
+{
+   const uint8_t *bytes = static_cast<const uint8_t *>(data);
+   uint64_t hash = 0xcbf29ce484222325ull;
+   for (uint64_t c = 0; c < nrOfBytes; c++)
+      hash = (hash ^ bytes[c]) * 0x100000001b3ull;
+   return hash;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether a geometry is identical to the one stored for a level of detail, as hashes can collide. The stored 
+ * geometry is read back from the arena and compared as the GPU would see it (i.e., once quantized, for compact LODs).
+ * @param lod level of detail
+ * @param nrOfVertices number of vertices
+ * @param vertices vertex data (Vbo::VertexData)
+ * @param nrOfFaces number of faces
+ * @param faces face data (Ebo::FaceData)
+ * @return true if identical, false otherwise
+ */
+static bool isSameGeometry(const Lod &lod, uint32_t nrOfVertices, const void *vertices, uint32_t nrOfFaces, const void *faces)
+{
+   if (lod.allocation.nrOfVertices != nrOfVertices || lod.allocation.nrOfFaces != nrOfFaces)
+      return false;
+
+   std::vector<Eng::Vbo::VertexData> storedVertices(nrOfVertices);
+   std::vector<Eng::Ebo::FaceData> storedFaces(nrOfFaces);
+   if (!Eng::Arena::getInstance().download(lod.allocation, storedVertices.data(), storedFaces.data()))
+      return false;
+   if (nrOfFaces && memcmp(storedFaces.data(), faces, nrOfFaces * sizeof(Eng::Ebo::FaceData)) != 0)
+      return false;
+
+   // Compact vertices are stored quantized:
+   if (lod.allocation.format == Eng::Vbo::Format::compact)
+   {
+      std::vector<Eng::Vbo::CompactVertexData> compact(nrOfVertices);
+      std::vector<Eng::Vbo::VertexData> expected(nrOfVertices);
+      glm::vec3 scale, bias;
+      Eng::Vbo::quantize(nrOfVertices, vertices, compact.data(), scale, bias);
+      Eng::Vbo::dequantize(nrOfVertices, compact.data(), scale, bias, expected.data());
+      return nrOfVertices == 0 || memcmp(storedVertices.data(), expected.data(), nrOfVertices * sizeof(Eng::Vbo::VertexData)) == 0;
+   }
+
+   return nrOfVertices == 0 || memcmp(storedVertices.data(), vertices, nrOfVertices * sizeof(Eng::Vbo::VertexData)) == 0;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the arena range for the given geometry, reusing the one of an identical geometry when already uploaded.
+ * @param nrOfVertices number of vertices
+ * @param vertices vertex data (Vbo::VertexData)
+ * @param nrOfFaces number of faces
+ * @param faces face data (Ebo::FaceData)
+ * @param format vertex layout to use on the GPU
+ * @return shared range, or nullptr if error
+ */
+static std::shared_ptr<Lod> acquireLod(uint32_t nrOfVertices, const void *vertices, uint32_t nrOfFaces, const void *faces, Eng::Vbo::Format format)
+{
+   const GeometryKey key{ hashBytes(vertices, static_cast<uint64_t>(nrOfVertices) * sizeof(Eng::Vbo::VertexData)),
+                          hashBytes(faces, static_cast<uint64_t>(nrOfFaces) * sizeof(Eng::Ebo::FaceData)),
+                          nrOfVertices, nrOfFaces, format };
+   std::map<GeometryKey, std::weak_ptr<Lod>> &cache = getGeometryCache();
+   auto cached = cache.find(key);
+   if (cached != cache.end())
+   {
+      std::shared_ptr<Lod> lod = cached->second.lock();
+      if (lod && isSameGeometry(*lod, nrOfVertices, vertices, nrOfFaces, faces))
+      {
+         ENG_LOG_DEBUG("Geometry shared (v: %u, f: %u)", nrOfVertices, nrOfFaces);
+         return lod;
+      }
+      ENG_LOG_DEBUG("Geometry hash collision (v: %u, f: %u)", nrOfVertices, nrOfFaces);
+   }
+
+   std::shared_ptr<Lod> lod = std::make_shared<Lod>();
+   lod->id = ++lastGeometryId;
+   lod->key = key;
+   if (!Eng::Arena::getInstance().allocate(nrOfVertices, vertices, nrOfFaces, faces, format, lod->allocation))
+   {
+      ENG_LOG_ERROR("Unable to store geometry (v: %u, f: %u)", nrOfVertices, nrOfFaces);
+      return nullptr;
+   }
+
+   // Colliding geometry is kept out of the cache (the first one keeps its entry):
+   if (cached == cache.end())
+   {
+      cache.emplace(key, lod);
+      lod->cached = true;
+   }
+
+   // Done:
+   return lod;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Binds the arena VAO of a level of detail and passes its vertex layout to the current program.
+ * @param lod level of detail
+ * @param program current program
+ */
+static void bindLod(const Lod &lod, Eng::Program &program)
+{
+   const bool compact = lod.allocation.format == Eng::Vbo::Format::compact;
+   program.setInt("vertexCompact", compact);
+   if (compact)
+   {
+      program.setVec3("vertexScale", lod.allocation.scale);
+      program.setVec3("vertexBias", lod.allocation.bias);
+   }
+   Eng::Arena::getInstance().render(static_cast<uint32_t>(lod.allocation.format));
+}
+
+
+
 ////////////////////////
 // BODY OF CLASS Mesh //
 ////////////////////////
@@ -70,6 +444,7 @@ struct Eng::Mesh::Reserved
 ENG_API Eng::Mesh::Mesh() : reserved(std::make_unique<Eng::Mesh::Reserved>())
 {	
    ENG_LOG_DETAIL("[+]");   
+   typeTags = tags;
 }
 
 
@@ -81,6 +456,7 @@ ENG_API Eng::Mesh::Mesh() : reserved(std::make_unique<Eng::Mesh::Reserved>())
 ENG_API Eng::Mesh::Mesh(const std::string &name) : Eng::Node(name),  reserved(std::make_unique<Eng::Mesh::Reserved>())
 {	
    ENG_LOG_DETAIL("[+]");   
+   typeTags = tags;
 }
 
 
@@ -91,6 +467,7 @@ ENG_API Eng::Mesh::Mesh(const std::string &name) : Eng::Node(name),  reserved(st
 ENG_API Eng::Mesh::Mesh(Mesh &&other) : Eng::Node(std::move(other)), reserved(std::move(other.reserved))
 {  
    ENG_LOG_DETAIL("[M]");   
+   typeTags = tags;
 }
 
 
@@ -134,7 +511,7 @@ const Eng::Material ENG_API &Eng::Mesh::getMaterial() const
 /**
  * Loads the specific information of a given object. In its base class, this function loads the file version chunk.
  * @param serializer serial data
- * @param data optional pointer
+ * @param data optional pointer to an Ovo::Mode (immediate if nullptr)
  * @return TF
  */
 uint32_t ENG_API Eng::Mesh::loadChunk(Eng::Serializer &serial, void *data)
@@ -169,20 +546,13 @@ uint32_t ENG_API Eng::Mesh::loadChunk(Eng::Serializer &serial, void *data)
    uint8_t subtype;
    serial.deserialize(subtype);
    
-   std::string materialName;
-   serial.deserialize(materialName);      
-   std::reference_wrapper<const Eng::Material> mat = Eng::Material::empty;
-   mat = dynamic_cast<Eng::Material &>(Eng::Container::getInstance().find(materialName));
-   this->setMaterial(mat);
+   serial.deserialize(reserved->pendingMaterial);      
 
-   float radius;
-   serial.deserialize(radius);
+   serial.deserialize(reserved->radius);
 
-   glm::vec3 bboxMin;
-   serial.deserialize(bboxMin);
-
-   glm::vec3 bboxMax;
-   serial.deserialize(bboxMax);
+   serial.deserialize(reserved->bboxMin);
+   serial.deserialize(reserved->bboxMax);
+   this->invalidateBounds();
 
    uint8_t hasPhysics;
    serial.deserialize(hasPhysics);
@@ -194,6 +564,8 @@ uint32_t ENG_API Eng::Mesh::loadChunk(Eng::Serializer &serial, void *data)
 
    uint32_t nrOfLods;
    serial.deserialize(nrOfLods);
+   reserved->pendingLods.clear();
+   reserved->pendingLods.reserve(nrOfLods);
 
    for (uint32_t curLod = 0; curLod < nrOfLods; curLod++)
    {
@@ -205,47 +577,459 @@ uint32_t ENG_API Eng::Mesh::loadChunk(Eng::Serializer &serial, void *data)
 
       ENG_LOG_PLAIN("LOD: %u, v: %u, f: %u", curLod + 1, nrOfVertices, nrOfFaces);
 
-      std::vector<Eng::Vbo::VertexData> allVertices(nrOfVertices);
-      serial.deserialize(allVertices.data(), nrOfVertices * sizeof(Eng::Vbo::VertexData));
-
-      std::vector<Eng::Ebo::FaceData> allFaces(nrOfFaces);
-      serial.deserialize(allFaces.data(), nrOfFaces * sizeof(Eng::Ebo::FaceData));
+      // Vertex and face data are used in place (no staging copy), as raw memory (not necessarily aligned):
+      const uint8_t *allVertices = serial.readSpan<uint8_t>(static_cast<uint64_t>(nrOfVertices) * sizeof(Eng::Vbo::VertexData));
+      const uint8_t *allFaces = serial.readSpan<uint8_t>(static_cast<uint64_t>(nrOfFaces) * sizeof(Eng::Ebo::FaceData));
+      if (allVertices == nullptr || allFaces == nullptr)
+         return 0;
 
-      // Store only first LOD for now:
-      if (curLod == 0)
-      {
-         reserved->vao.init();
-         reserved->vao.render();
-         
-         reserved->vbo.create(nrOfVertices, allVertices.data());
-         reserved->ebo.create(nrOfFaces, allFaces.data());
-      }
+      reserved->pendingLods.push_back({ allVertices, nrOfVertices, allFaces, nrOfFaces });
    }   
 
+   // Create GPU resources now, unless deferred:
+   if (data == nullptr || *static_cast<Eng::Ovo::Mode *>(data) != Eng::Ovo::Mode::deferred)
+      upload();
+
    // Done:      
    return nrOfChildren;
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Saves the specific information of a given object as a new chunk. Geometry is read back from the GPU buffers.
+ * @param serial serial data
+ * @return TF
+ */
+bool ENG_API Eng::Mesh::saveChunk(Eng::Serializer &serial) const
+{
+   // Read back all the LODs first:
+   std::vector<std::vector<Eng::Vbo::VertexData>> allVertices(reserved->lods.size());
+   std::vector<std::vector<Eng::Ebo::FaceData>> allFaces(reserved->lods.size());
+   for (uint32_t c = 0; c < reserved->lods.size(); c++)
+   {
+      const Lod &lod = *reserved->lods[c];
+      allVertices[c].resize(lod.allocation.nrOfVertices);
+      allFaces[c].resize(lod.allocation.nrOfFaces);
+      if (!Eng::Arena::getInstance().download(lod.allocation, allVertices[c].data(), allFaces[c].data()))
+         return false;
+   }
+   const bool hasBbox = glm::all(glm::lessThanEqual(reserved->bboxMin, reserved->bboxMax));
+   const glm::vec3 bboxMin = hasBbox ? reserved->bboxMin : glm::vec3(0.0f);
+   const glm::vec3 bboxMax = hasBbox ? reserved->bboxMax : glm::vec3(0.0f);
+
+   const uint64_t start = beginChunk(serial, Ovo::ChunkId::mesh);
+
+   // Node properties:
+   serial.serialize(this->getName());
+   serial.serialize(this->getMatrix());
+   serial.serialize(this->getNrOfChildren());
+   serial.serialize(std::string("[none]")); // Target
+
+   // Data:
+   serial.serialize(static_cast<uint8_t>(0));         // Subtype (default)
+   const Eng::Material &mat = reserved->material;
+   serial.serialize((mat == Eng::Material::empty) ? std::string("[none]") : mat.getName());
+   serial.serialize(reserved->radius);
+   serial.serialize(bboxMin);
+   serial.serialize(bboxMax);
+   serial.serialize(static_cast<uint8_t>(0));         // No physics
+
+   serial.serialize(static_cast<uint32_t>(reserved->lods.size()));
+   for (uint32_t c = 0; c < reserved->lods.size(); c++)
+   {
+      serial.serialize(static_cast<uint32_t>(allVertices[c].size()));
+      serial.serialize(static_cast<uint32_t>(allFaces[c].size()));
+      serial.writeSpan(allVertices[c].data(), allVertices[c].size());
+      serial.writeSpan(allFaces[c].data(), allFaces[c].size());
+   }
+
+   // Done:
+   return endChunk(serial, start);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Resolves the material and creates the GPU buffers of the data parsed by loadChunk(). Must be called from the 
+ * main thread while the serialized data is still available.
+ * @return TF
+ */
+bool ENG_API Eng::Mesh::upload()
+{
+   // Material (may be missing):
+   if (!reserved->pendingMaterial.empty())
+   {
+      Eng::Material &mat = Eng::Container::getInstance().find<Eng::Material>(reserved->pendingMaterial);
+      if (mat != Eng::Material::empty)
+         this->setMaterial(mat);
+      reserved->pendingMaterial.clear();
+   }
+
+   // Buffers (one set per LOD):
+   if (!reserved->pendingLods.empty())
+   {
+      reserved->lods.clear();
+      for (auto &pending : reserved->pendingLods)
+         if (!addLod(pending.nrOfVertices, pending.vertices, pending.nrOfFaces, pending.faces))
+         {
+            reserved->pendingLods.clear();
+            return false;
+         }
+      reserved->pendingLods.clear();
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Uploads a new level of detail into the geometry arena, coarser than the ones already available. Ranges are shared with 
+ * the meshes already having the same geometry.
+ * @param nrOfVertices number of vertices
+ * @param vertices vertex data (Vbo::VertexData, not necessarily aligned)
+ * @param faces face data (Ebo::FaceData, not necessarily aligned)
+ * @param faces face data (Ebo::FaceData)
+ * @return TF
+ */
+bool ENG_API Eng::Mesh::addLod(uint32_t nrOfVertices, const void *vertices, uint32_t nrOfFaces, const void *faces)
+{
+   // Safety net:
+   if ((nrOfVertices && vertices == nullptr) || (nrOfFaces && faces == nullptr))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Bounding box from the most detailed LOD, when not given:
+   if (reserved->lods.empty() && glm::any(glm::greaterThan(reserved->bboxMin, reserved->bboxMax)))
+   {
+      const uint8_t *allVertices = static_cast<const uint8_t *>(vertices);
+      for (uint32_t c = 0; c < nrOfVertices; c++)
+      {
+         glm::vec3 position;
+         std::memcpy(&position, allVertices + c * sizeof(Eng::Vbo::VertexData) + offsetof(Eng::Vbo::VertexData, vertex), sizeof(glm::vec3));
+         reserved->bboxMin = glm::min(reserved->bboxMin, position);
+         reserved->bboxMax = glm::max(reserved->bboxMax, position);
+      }
+      this->invalidateBounds();
+   }
+
+   std::shared_ptr<Lod> lod = acquireLod(nrOfVertices, vertices, nrOfFaces, faces, reserved->format);
+   if (lod == nullptr)
+      return false;
+   reserved->lods.push_back(std::move(lod));
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the vertex layout used on the GPU. LODs already uploaded are converted (through a read back), LODs added later
+ * use the new layout. The mesh is left unchanged if any LOD cannot be converted. The compact layout trades some 
+ * precision for less vertex bandwidth.
+ * @param format vertex layout
+ * @return TF
+ */
+bool ENG_API Eng::Mesh::setVertexFormat(Eng::Vbo::Format format)
+{
+   // Safety net:
+   if (format == Eng::Vbo::Format::last)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   if (format == reserved->format)
+      return true;
+
+   // Convert existing LODs (into new ranges, the current ones may be shared), all or none:
+   std::vector<std::shared_ptr<Lod>> lods;
+   std::vector<Eng::Vbo::VertexData> vertices;
+   std::vector<Eng::Ebo::FaceData> faces;
+   for (auto &lod : reserved->lods)
+   {
+      vertices.resize(lod->allocation.nrOfVertices);
+      faces.resize(lod->allocation.nrOfFaces);
+      if (!Eng::Arena::getInstance().download(lod->allocation, vertices.data(), faces.data()))
+         return false;
+      lods.push_back(acquireLod(static_cast<uint32_t>(vertices.size()), vertices.data(), static_cast<uint32_t>(faces.size()), faces.data(), format));
+      if (lods.back() == nullptr)
+         return false;
+   }
+   reserved->lods.swap(lods);
+   reserved->format = format;
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the vertex layout used on the GPU.
+ * @return vertex layout
+ */
+Eng::Vbo::Format ENG_API Eng::Mesh::getVertexFormat() const
+{
+   return reserved->format;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Optimizes the data of a level of detail in place, before its upload: triangles are reordered for the post-transform 
+ * vertex cache (unless the original order is already better), then vertices for fetch locality (in order of first use, 
+ * unused ones last). The geometry is unchanged. ACMR/ATVR before and after are logged.
+ * @param nrOfVertices number of vertices
+ * @param vertices vertex data
+ * @param nrOfFaces number of faces
+ * @param faces face data
+ * @return TF
+ */
+bool ENG_API Eng::Mesh::optimize(uint32_t nrOfVertices, Eng::Vbo::VertexData *vertices, uint32_t nrOfFaces, Eng::Ebo::FaceData *faces)
+{
+   // Safety net:
+   if ((nrOfVertices && vertices == nullptr) || (nrOfFaces && faces == nullptr))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   std::vector<uint32_t> indices(static_cast<size_t>(nrOfFaces) * 3);
+   if (nrOfFaces)
+      std::memcpy(indices.data(), faces, indices.size() * sizeof(uint32_t));
+   if (std::any_of(indices.begin(), indices.end(), [nrOfVertices](uint32_t i) { return i >= nrOfVertices; }))
+   {
+      ENG_LOG_ERROR("Index out of range");
+      return false;
+   }
+
+   float acmrBefore, atvrBefore;
+   measureCache(indices, nrOfVertices, acmrBefore, atvrBefore);
+
+   // Triangles (kept as they are if already better ordered):
+   std::vector<uint32_t> original = indices;
+   reorderTriangles(indices, nrOfVertices);
+   float acmrAfter, atvrAfter;
+   measureCache(indices, nrOfVertices, acmrAfter, atvrAfter);
+   if (acmrAfter >= acmrBefore)
+   {
+      indices.swap(original);
+      acmrAfter = acmrBefore;
+      atvrAfter = atvrBefore;
+   }
+
+   // Vertices, in order of first use:
+   std::vector<uint32_t> remap(nrOfVertices, std::numeric_limits<uint32_t>::max());
+   std::vector<Eng::Vbo::VertexData> reordered(nrOfVertices);
+   uint32_t next = 0;
+   for (auto &i : indices)
+   {
+      if (remap[i] == std::numeric_limits<uint32_t>::max())
+      {
+         reordered[next] = vertices[i];
+         remap[i] = next++;
+      }
+      i = remap[i];
+   }
+   for (uint32_t v = 0; v < nrOfVertices; v++)
+      if (remap[v] == std::numeric_limits<uint32_t>::max())
+         reordered[next++] = vertices[v];
+
+   std::copy(reordered.begin(), reordered.end(), vertices);
+   if (nrOfFaces)
+      std::memcpy(static_cast<void *>(faces), indices.data(), indices.size() * sizeof(uint32_t));
+
+   // Done:
+   ENG_LOG_PLAIN("Vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", acmrBefore, acmrAfter, atvrBefore, atvrAfter);
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of levels of detail available on the GPU.
+ * @return number of LODs
+ */
+uint32_t ENG_API Eng::Mesh::getNrOfLods() const
+{
+   return static_cast<uint32_t>(reserved->lods.size());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets an identifier of the geometry used by a given level of detail: meshes sharing the same geometry return the 
+ * same value.
+ * @param lod level of detail (clamped to the coarsest one available)
+ * @return geometry identifier, or 0 if there are no LODs
+ */
+uint32_t ENG_API Eng::Mesh::getGeometryId(uint32_t lod) const
+{
+   if (reserved->lods.empty())
+      return 0;
+   return reserved->lods[std::min<size_t>(lod, reserved->lods.size() - 1)]->id;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the range of the geometry arena used by a given level of detail, as needed to build indirect draw commands.
+ * @param lod level of detail (clamped to the coarsest one available)
+ * @return arena allocation, empty if there are no LODs
+ */
+Eng::Arena::Allocation ENG_API Eng::Mesh::getAllocation(uint32_t lod) const
+{
+   if (reserved->lods.empty())
+      return Eng::Arena::Allocation();
+   return reserved->lods[std::min<size_t>(lod, reserved->lods.size() - 1)]->allocation;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of faces of a given level of detail.
+ * @param lod level of detail (0 is the most detailed)
+ * @return number of faces, or 0 if the LOD does not exist
+ */
+uint32_t ENG_API Eng::Mesh::getNrOfFaces(uint32_t lod) const
+{
+   if (lod >= reserved->lods.size())
+      return 0;
+   return reserved->lods[lod]->allocation.nrOfFaces;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the radius of the bounding sphere, centered on the mesh origin.
+ * @param radius bounding sphere radius
+ */
+void ENG_API Eng::Mesh::setRadius(float radius)
+{
+   reserved->radius = radius;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the radius of the bounding sphere, centered on the mesh origin.
+ * @return bounding sphere radius
+ */
+float ENG_API Eng::Mesh::getRadius() const
+{
+   return reserved->radius;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the bounding box, in local coordinates. Computed from the first LOD when not set before adding it.
+ * @param bboxMin minimum corner
+ * @param bboxMax maximum corner
+ * @return TF
+ */
+bool ENG_API Eng::Mesh::setBoundingBox(const glm::vec3 &bboxMin, const glm::vec3 &bboxMax)
+{
+   // Safety net:
+   if (glm::any(glm::greaterThan(bboxMin, bboxMax)))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   reserved->bboxMin = bboxMin;
+   reserved->bboxMax = bboxMax;
+   this->invalidateBounds();
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the minimum corner of the bounding box, in local coordinates.
+ * @return minimum corner (greater than the maximum one when the box is empty)
+ */
+const glm::vec3 ENG_API &Eng::Mesh::getBoundingBoxMin() const
+{
+   return reserved->bboxMin;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the maximum corner of the bounding box, in local coordinates.
+ * @return maximum corner (lower than the minimum one when the box is empty)
+ */
+const glm::vec3 ENG_API &Eng::Mesh::getBoundingBoxMax() const
+{
+   return reserved->bboxMax;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Rendering method. 
- * @param value generic value
+ * @param value level of detail (clamped to the coarsest one available)
  * @param data generic pointer to any kind of data
  * @return TF
  */
 bool ENG_API Eng::Mesh::render(uint32_t value, void *data) const
 {	
-   Eng::Program &program = dynamic_cast<Eng::Program &>(Eng::Program::getCached());
+   Eng::Program &program = Eng::Program::getCached();
    program.setMat4("modelviewMat", *((glm::mat4 *) data));
    program.setMat4("worldMat", this->getWorldMatrix());
-   program.setMat3("normalMat", glm::inverseTranspose(glm::mat3(*((glm::mat4 *) data))));
+   program.setMat3("normalMat", Eng::Math::normalMatrix(*((glm::mat4 *) data)));
+   program.setInt("instanced", 0);
 
    reserved->material.get().render();
+
+   // Nothing to draw:
+   if (reserved->lods.empty())
+      return true;
   
-   reserved->vao.render();   
-   glDrawElements(GL_TRIANGLES, reserved->ebo.getNrOfFaces() * 3, GL_UNSIGNED_INT, nullptr);
+   const Lod &lod = *reserved->lods[std::min<size_t>(value, reserved->lods.size() - 1)];
+   bindLod(lod, program);
+   glDrawElementsBaseVertex(GL_TRIANGLES, lod.allocation.nrOfFaces * 3, lod.allocation.indexType, 
+                            reinterpret_cast<void *>(lod.allocation.indexOffset), static_cast<GLint>(lod.allocation.baseVertex));
    
    // Done:
    return true;
 }
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Renders several instances of this mesh with a single draw call. The per-instance matrices are read by the shaders 
+ * from the buffer bound to shader storage binding point 0, starting at the given instance (see List::render()).
+ * @param lod level of detail (clamped to the coarsest one available)
+ * @param nrOfInstances number of instances
+ * @param firstInstance index of the first instance in the per-instance buffer
+ * @return TF
+ */
+bool ENG_API Eng::Mesh::renderInstances(uint32_t lod, uint32_t nrOfInstances, uint32_t firstInstance) const
+{
+   Eng::Program &program = Eng::Program::getCached();
+   program.setInt("instanced", 1);
+   program.setUInt("firstInstance", firstInstance);
+
+   reserved->material.get().render();
+
+   // Nothing to draw:
+   if (reserved->lods.empty() || nrOfInstances == 0)
+      return true;
+
+   const Lod &range = *reserved->lods[std::min<size_t>(lod, reserved->lods.size() - 1)];
+   bindLod(range, program);
+   glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.allocation.nrOfFaces * 3, range.allocation.indexType, 
+                                     reinterpret_cast<void *>(range.allocation.indexOffset), static_cast<GLsizei>(nrOfInstances), 
+                                     static_cast<GLint>(range.allocation.baseVertex));
+
+   // Done:
+   return true;
+}
@@ -20,6 +20,9 @@ public: //
    // Special values:
    static Mesh empty;   
 
+   // Type tags:
+   static constexpr uint32_t tags = Eng::Node::tags | static_cast<uint32_t>(Tag::mesh);
+
    // Const/dest:
    Mesh();
    Mesh(Mesh &&other);
@@ -32,12 +35,30 @@ public: //
    // Get/set:
    bool setMaterial(const Eng::Material &mat);
    const Eng::Material &getMaterial() const;
+   uint32_t getNrOfLods() const;
+   uint32_t getNrOfFaces(uint32_t lod = 0) const;
+   uint32_t getGeometryId(uint32_t lod = 0) const;
+   Eng::Arena::Allocation getAllocation(uint32_t lod = 0) const;
+   void setRadius(float radius);
+   float getRadius() const;
+   bool setBoundingBox(const glm::vec3 &bboxMin, const glm::vec3 &bboxMax);
+   const glm::vec3 &getBoundingBoxMin() const;
+   const glm::vec3 &getBoundingBoxMax() const;
+   bool setVertexFormat(Eng::Vbo::Format format);
+   Eng::Vbo::Format getVertexFormat() const;
+
+   // LOD management:
+   bool addLod(uint32_t nrOfVertices, const void *vertices, uint32_t nrOfFaces, const void *faces);
+   static bool optimize(uint32_t nrOfVertices, Eng::Vbo::VertexData *vertices, uint32_t nrOfFaces, Eng::Ebo::FaceData *faces);
    
    // Rendering methods:   
    bool render(uint32_t value = 0, void *data = nullptr) const;   
+   bool renderInstances(uint32_t lod, uint32_t nrOfInstances, uint32_t firstInstance = 0) const;
 
    // Ovo:   
    uint32_t loadChunk(Eng::Serializer &serial, void *data = nullptr) override;
+   bool saveChunk(Eng::Serializer &serial) const override;
+   bool upload() override;
 
 
 ///////////
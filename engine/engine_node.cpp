@@ -16,6 +16,7 @@
 
    // C/C++:
    #include <map>
+   #include <limits>
 
    
 
@@ -25,6 +26,22 @@
 
    // Special values:
    Eng::Node Eng::Node::empty("[empty]");      
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Appends a node and its subtree to a string representation of the hierarchy, one node per line.
+ * @param node node to append
+ * @param depth depth of the node (indentation)
+ * @param output string to append to
+ */
+static void appendTree(const Eng::Node &node, uint32_t depth, std::string &output)
+{
+   output += std::string(depth, ' ') + "+ " + node.getName();
+   output += '\n';
+   for (auto &child : node.getListOfChildren())
+      appendTree(child.get(), depth + 1, output);
+}
    
 
 
@@ -35,18 +52,29 @@
 /**
  * @brief Node reserved structure.
  */
-struct Eng::Node::Reserved
+struct Eng::Node::Reserved : Eng::Pooled<Eng::Node::Reserved>
 {  
    glm::mat4 matrix;                                                    ///< Node matrix
+   glm::mat4 worldMatrix;                                               ///< Cached world matrix
+   bool worldDirty;                                                     ///< True when the world matrix must be recomputed
    std::reference_wrapper<Eng::Node> parent;                            ///< Parent node
-   std::list<std::reference_wrapper<Eng::Node>> children;               ///< List of children nodes      
+   std::vector<std::reference_wrapper<Eng::Node>> children;             ///< Children nodes (contiguous, in insertion order)
+
+   // Subtree bounds:
+   glm::vec3 bboxMin;                                                   ///< Subtree box minimum, in node coordinates
+   glm::vec3 bboxMax;                                                   ///< Subtree box maximum (empty when below the minimum)
+   bool unbounded;                                                      ///< True when the subtree holds lights
+   bool boundsDirty;                                                    ///< True when the bounds must be recomputed
 
 
    /**
     * Constructor. 
     */
    Reserved() : matrix{ 1.0f },
-                parent{ Eng::Node::empty }
+                worldMatrix{ 1.0f }, worldDirty{ true },
+                parent{ Eng::Node::empty },
+                bboxMin{ std::numeric_limits<float>::max() }, bboxMax{ -std::numeric_limits<float>::max() },
+                unbounded{ false }, boundsDirty{ true }
    {}
 };
 
@@ -63,6 +91,7 @@ struct Eng::Node::Reserved
 ENG_API Eng::Node::Node() : reserved(std::make_unique<Eng::Node::Reserved>())
 {		
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -74,6 +103,7 @@ ENG_API Eng::Node::Node() : reserved(std::make_unique<Eng::Node::Reserved>())
 ENG_API Eng::Node::Node(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Node::Reserved>())
 {	   
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -84,6 +114,7 @@ ENG_API Eng::Node::Node(const std::string &name) : Eng::Object(name), reserved(s
 ENG_API Eng::Node::Node(Node &&other) : Eng::Object(std::move(other)), reserved(std::move(other.reserved))
 { 
    ENG_LOG_DETAIL("[M]");
+   typeTags = tags;
 }
 
 
@@ -105,6 +136,8 @@ ENG_API Eng::Node::~Node()
 void ENG_API Eng::Node::setMatrix(const glm::mat4 &matrix) 
 {		
    reserved->matrix = matrix;
+   this->invalidateWorldMatrix();
+   reserved->parent.get().invalidateBounds();
 }
 
 
@@ -121,12 +154,25 @@ const glm::mat4 ENG_API &Eng::Node::getMatrix() const
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Gets the world coordinate matrix of this node starting from the specified node (if empty, root node is used)
+ * Gets the world coordinate matrix of this node starting from the specified node (if empty, root node is used). World
+ * matrices (from the root) are cached, and only recomputed after a change of matrix or parent along the branch.
  * @param node starting node (root if empty)
  * @return world coordinate glm 4x4 matrix
  */
 glm::mat4 ENG_API Eng::Node::getWorldMatrix(Eng::Node &root) const
 {	
+   // From the root, cached:
+   if (root == Eng::Node::empty)
+   {
+      if (reserved->worldDirty)
+      {
+         const Eng::Node &parent = reserved->parent.get();
+         reserved->worldMatrix = (parent == Eng::Node::empty) ? reserved->matrix : parent.getWorldMatrix() * reserved->matrix;
+         reserved->worldDirty = false;
+      }
+      return reserved->worldMatrix;
+   }
+
    auto current = std::reference_wrapper<Eng::Node>(const_cast<Eng::Node &>(* this));   
    glm::mat4 result = glm::mat4(1.0f);
 
@@ -142,6 +188,80 @@ glm::mat4 ENG_API Eng::Node::getWorldMatrix(Eng::Node &root) const
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the bounding box of this node and of its whole subtree, in the coordinates of this node (i.e., before applying 
+ * its matrix). Bounds are cached and only recomputed along the branches changed since the last call.
+ * @param bboxMin resulting box minimum (above the maximum when the subtree holds no geometry)
+ * @param bboxMax resulting box maximum
+ * @return true if bounded, false if the subtree holds lights (which must never be culled)
+ */
+bool ENG_API Eng::Node::getSubtreeBounds(glm::vec3 &bboxMin, glm::vec3 &bboxMax) const
+{
+   if (reserved->boundsDirty)
+   {
+      reserved->bboxMin = glm::vec3(std::numeric_limits<float>::max());
+      reserved->bboxMax = glm::vec3(-std::numeric_limits<float>::max());
+      reserved->unbounded = this->is<Eng::Light>();
+
+      const Eng::Mesh *mesh = this->is<Eng::Mesh>() ? &this->as<Eng::Mesh>() : nullptr;
+      if (mesh)
+      {
+         reserved->bboxMin = mesh->getBoundingBoxMin();
+         reserved->bboxMax = mesh->getBoundingBoxMax();
+      }
+
+      for (auto &child : reserved->children)
+      {
+         glm::vec3 childMin, childMax;
+         if (child.get().getSubtreeBounds(childMin, childMax) == false)
+            reserved->unbounded = true;
+         else if (glm::all(glm::lessThanEqual(childMin, childMax)))
+         {
+            // Axis-aligned box enclosing the transformed child box:
+            const glm::mat4 &m = child.get().getMatrix();
+            const glm::vec3 center = glm::vec3(m * glm::vec4((childMin + childMax) * 0.5f, 1.0f));
+            const glm::vec3 halfSize = (childMax - childMin) * 0.5f;
+            const glm::vec3 extent = glm::abs(glm::vec3(m[0])) * halfSize.x + glm::abs(glm::vec3(m[1])) * halfSize.y + glm::abs(glm::vec3(m[2])) * halfSize.z;
+            reserved->bboxMin = glm::min(reserved->bboxMin, center - extent);
+            reserved->bboxMax = glm::max(reserved->bboxMax, center + extent);
+         }
+      }
+      reserved->boundsDirty = false;
+   }
+
+   bboxMin = reserved->bboxMin;
+   bboxMax = reserved->bboxMax;
+   return !reserved->unbounded;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Marks the bounds of this node, and of all its ancestors, for recomputation.
+ */
+void ENG_API Eng::Node::invalidateBounds()
+{
+   for (Eng::Node *node = this; *node != Eng::Node::empty && !node->reserved->boundsDirty; node = &node->getParent())
+      node->reserved->boundsDirty = true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Marks the cached world matrix of this node, and of all its descendants, for recomputation. Descendants of a node 
+ * already marked are already marked too.
+ */
+void ENG_API Eng::Node::invalidateWorldMatrix()
+{
+   if (reserved->worldDirty)
+      return;
+   reserved->worldDirty = true;
+   for (auto &child : reserved->children)
+      child.get().invalidateWorldMatrix();
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////	 
 /** 
  * Returns the parent node. 
@@ -161,6 +281,7 @@ Eng::Node ENG_API &Eng::Node::getParent() const
 void ENG_API Eng::Node::setParent(Eng::Node &parent)
 {	   
 	reserved->parent = parent;
+   this->invalidateWorldMatrix();
 }
 
 
@@ -179,11 +300,7 @@ Eng::Node ENG_API &Eng::Node::getChild(uint32_t id) const
 		return Node::empty;
 	}		
 	
-	// Iterate up to the good one:	
-	auto i = reserved->children.begin();				
-	for (uint32_t c = 0; c < id; c++)	
-		i++;		
-	return i->get();		
+	return reserved->children[id].get();		
 }
 
 
@@ -202,15 +319,12 @@ Eng::Node ENG_API &Eng::Node::removeChild(uint32_t id)
 		return Eng::Node::empty;
 	}		
 	
-	// Iterate up to the good one:	
-	auto i = reserved->children.begin();				
-	for (unsigned int c = 0; c < id; c++)	
-		i++;
-
    // Remove and update:
+   auto i = reserved->children.begin() + id;
    i->get().setParent(Eng::Node::empty);
    auto &x = i->get();
    reserved->children.erase(i);   
+   this->invalidateBounds();
 	return x;		
 }
 
@@ -240,6 +354,7 @@ bool ENG_API Eng::Node::addChild(Eng::Node &child)
 	// Add and update:
    reserved->children.push_back(child);	
    child.setParent(*this);
+   this->invalidateBounds();
    return true;
 }
 
@@ -260,7 +375,7 @@ uint32_t ENG_API Eng::Node::getNrOfChildren() const
  * Returns (as read-only) the internal list of children. This is used for perfomance reasons, to avoid iterating too much over the list.
  * @return reference to the internal list of children
  */	
-const std::list<std::reference_wrapper<Eng::Node>> ENG_API &Eng::Node::getListOfChildren() const
+const std::vector<std::reference_wrapper<Eng::Node>> ENG_API &Eng::Node::getListOfChildren() const
 {	   
    return reserved->children;	
 }
@@ -305,6 +420,27 @@ uint32_t ENG_API Eng::Node::loadChunk(Eng::Serializer &serial, void *data)
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Saves the specific information of a given object as a new chunk.
+ * @param serial serial data
+ * @return TF
+ */
+bool ENG_API Eng::Node::saveChunk(Eng::Serializer &serial) const
+{
+   const uint64_t start = beginChunk(serial, Ovo::ChunkId::node);
+
+   // Node properties:
+   serial.serialize(this->getName());
+   serial.serialize(this->getMatrix());
+   serial.serialize(this->getNrOfChildren());
+   serial.serialize(std::string("[none]")); // Target
+
+   // Done:
+   return endChunk(serial, start);
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////	 
 /** 
  * Gets a string representation of the hierarchy tree. For debugging purposes. 
@@ -312,26 +448,9 @@ uint32_t ENG_API Eng::Node::loadChunk(Eng::Serializer &serial, void *data)
  */	
 std::string ENG_API Eng::Node::getTreeAsString() const
 {     
-   static std::string output = "";
-   static unsigned int calls = 0;
-   
-   // Reset on first:
-   if (calls == 0)
-      output = "";
-
-   // Update text:
-   output += std::string(calls, ' ') + "+ " + this->getName();   
-   output += '\n';   
-
-   // Recursion:
-   calls++;
-      for (auto &i : reserved->children)
-         i.get().getTreeAsString();
-   calls--;
+   std::string output;
+   appendTree(*this, 0, output);
    
    // Done:
-   if (calls == 0)
-      return output;
-   else
-      return "";
+   return output;
 }
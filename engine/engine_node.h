@@ -20,6 +20,9 @@ public: //
    // Special values:
    static Node empty;          
 
+   // Type tags:
+   static constexpr uint32_t tags = Eng::Object::tags | static_cast<uint32_t>(Tag::node);
+
    // Const/dest:
 	Node();      
 	Node(Node &&other);
@@ -34,16 +37,20 @@ public: //
    const glm::mat4 &getMatrix() const;
    glm::mat4 getWorldMatrix(Node &root = Node::empty) const;
 
+   // Bounds:
+   bool getSubtreeBounds(glm::vec3 &bboxMin, glm::vec3 &bboxMax) const;
+
    // Hierarchy:
    uint32_t getNrOfChildren() const;
    Node &getParent() const;
    bool addChild(Node &child);
    Node &getChild(uint32_t id) const;
    Node &removeChild(uint32_t id);   
-   const std::list<std::reference_wrapper<Node>> &getListOfChildren() const;      
+   const std::vector<std::reference_wrapper<Node>> &getListOfChildren() const;      
 
    // Ovo:   
    uint32_t loadChunk(Eng::Serializer &serial, void *data = nullptr) override;
+   bool saveChunk(Eng::Serializer &serial) const override;
    
    // Debugging:
    std::string getTreeAsString() const;
@@ -62,6 +69,12 @@ protected: //
 
    // Hierarchy:
    void setParent(Node &parent);
+
+   // Positioning:
+   void invalidateWorldMatrix();
+
+   // Bounds:
+   void invalidateBounds();
 };
 
 
@@ -14,6 +14,9 @@
    // Main include:
    #include "engine.h"
 
+   // C/C++:
+   #include <atomic>
+
 
 
 ////////////
@@ -23,9 +26,9 @@
    // Special values:
    Eng::Object Eng::Object::empty("[empty]");
 
-   // Parity check and counters:
-   static int32_t counter = 0;
-   static uint32_t idCounter = 0;
+   // Parity check and counters (objects can be created by loading threads):
+   static std::atomic<int32_t> counter = 0;
+   static std::atomic<uint32_t> idCounter = 0;
 
 
 
@@ -36,18 +39,19 @@
 /**
  * @brief Object reserved structure.
  */
-struct Eng::Object::Reserved
+struct Eng::Object::Reserved : Eng::Pooled<Eng::Object::Reserved>
 {
    // General:
    std::string name;                         ///< Name
    uint32_t id;                              ///< UID
    bool dirty;                               ///< Object needs update  
+   Eng::Container *container;                ///< Container storing the object, if any
 
 
    /**
     * Constructor.
     */
-   Reserved() : name{ "[none]" }, id{ idCounter++ }, dirty{ true }
+   Reserved() : name{ "[none]" }, id{ idCounter++ }, dirty{ true }, container{ nullptr }
    {
       counter++;
    }
@@ -71,7 +75,7 @@ struct Eng::Object::Reserved
 /**
  * Constructor.
  */
-ENG_API Eng::Object::Object() : reserved(std::make_unique<Eng::Object::Reserved>())
+ENG_API Eng::Object::Object() : reserved(std::make_unique<Eng::Object::Reserved>()), typeTags{ tags }
 {
    ENG_LOG_DETAIL("[+]");
 }
@@ -94,7 +98,7 @@ ENG_API Eng::Object::Object(const std::string &name) : Object()
 /**
  * Move constructor.
  */
-ENG_API Eng::Object::Object(Object &&other) : reserved(std::move(other.reserved))
+ENG_API Eng::Object::Object(Object &&other) : reserved(std::move(other.reserved)), typeTags{ other.typeTags }
 {
    ENG_LOG_DETAIL("[M]");
 }
@@ -150,8 +154,11 @@ void ENG_API Eng::Object::setName(const std::string &name)
       return;
    }
 
-   // Done:
+   // Keep the name index of the container up to date:
+   std::string oldName = std::move(reserved->name);
    reserved->name = name;
+   if (reserved->container && oldName != name)
+      reserved->container->rename(*this, oldName);
 }
 
 
@@ -188,6 +195,17 @@ int32_t ENG_API Eng::Object::getNrOfObjects()
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Sets the container storing the object, which is then notified when the object is renamed.
+ * @param container container, or nullptr
+ */
+void ENG_API Eng::Object::setContainer(Container *container)
+{
+   reserved->container = container;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Set the dirty flag.
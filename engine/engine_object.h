@@ -8,6 +8,15 @@
 
 
 
+///////////////
+// PREDEFINE //
+///////////////
+
+   // Objects notify the container storing them when renamed:
+   class Container;
+
+
+
 /**
  * @brief Class for modeling a generic, base object. This class is inherited by most of the engine classes.
  */
@@ -34,6 +43,28 @@ public: //
    };
 
 
+   /**
+    * @brief Type tags (one bit per tagged class), replacing dynamic_cast in the hot paths. An object carries the tags
+    *        of its class and of all its tagged base classes.
+    */
+   enum class Tag : uint32_t
+   {
+      none     = 0,
+      node     = 1 << 0,
+      mesh     = 1 << 1,
+      light    = 1 << 2,
+      camera   = 1 << 3,
+      material = 1 << 4,
+      texture  = 1 << 5,
+      bitmap   = 1 << 6,
+      shader   = 1 << 7,
+      program  = 1 << 8,
+   };
+
+   // Consts:
+   static constexpr uint32_t tags = static_cast<uint32_t>(Tag::none);   ///< Tags of the class
+
+
    // Const/dest:
    Object();
    Object(Object &&other);
@@ -52,6 +83,12 @@ public: //
    bool isDirty() const;
    void setDirty(bool dirty) const;
 
+   // Type:
+   uint32_t getTags() const { return typeTags; }
+   template <typename T> bool is() const;
+   template <typename T> T &as();
+   template <typename T> const T &as() const;
+
    // Statistics:
    static int32_t getNrOfObjects();
 
@@ -67,7 +104,73 @@ protected: //
    struct Reserved;
    std::unique_ptr<Reserved> reserved;
 
+   // Type:
+   uint32_t typeTags;      ///< Tags of the most derived class, set by its constructors
+
    // Const/dest:
    Object(const std::string &name);
+
+
+///////////
+private: //
+///////////
+
+   // Container storing the object (notified when the object is renamed):
+   friend class Container;
+   void setContainer(Container *container);
 };
 
+
+
+//////////////////////
+// TEMPLATE METHODS //
+//////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Tells whether the object is a T (or derives from it), without RTTI.
+ * @return true if the object is a T, false otherwise
+ */
+template <typename T>
+bool Object::is() const
+{
+   static_assert(std::is_same<T, Object>::value || T::tags != Object::tags, "Class without type tag");
+   return (typeTags & T::tags) == T::tags;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Casts the object to T (a static_cast, guarded by the type tags).
+ * @return object as a T, or T::empty if the object is not a T
+ */
+template <typename T>
+T &Object::as()
+{
+   // Safety net:
+   if (!is<T>())
+   {
+      ENG_LOG_ERROR("Invalid cast");
+      return T::empty;
+   }
+   return static_cast<T &>(*this);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Casts the object to T (a static_cast, guarded by the type tags).
+ * @return object as a T, or T::empty if the object is not a T
+ */
+template <typename T>
+const T &Object::as() const
+{
+   // Safety net:
+   if (!is<T>())
+   {
+      ENG_LOG_ERROR("Invalid cast");
+      return T::empty;
+   }
+   return static_cast<const T &>(*this);
+}
+
@@ -13,14 +13,738 @@
 
    // Main include:
    #include "engine.h"
-   #include <functional>
+   #include <algorithm>
+   #include <atomic>
+   #include <chrono>
+   #include <filesystem>
+   #include <fstream>
+   #include <limits>
    #include <map>
+   #include <thread>
 
    // GLM:
    #include <glm/gtc/packing.hpp>  
 
 
 
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief Entry of the chunk table built by the prescan.
+ */
+struct ChunkEntry
+{
+   uint32_t chunkId;                      ///< Chunk ID
+   uint64_t position;                     ///< Offset of the chunk header
+   uint32_t nrOfChildren;                 ///< Number of children nodes (node chunks only)
+   int64_t parent;                        ///< Index of the parent entry, -1 if none
+   std::unique_ptr<Eng::Object> object;   ///< Object decoded from the chunk
+   Eng::Ovo *loader;                      ///< Same object, seen as an OVO loader
+   Eng::Node *node;                       ///< Node stored in the container, once attached
+
+
+   /**
+    * Constructor.
+    */
+   ChunkEntry() : chunkId{ 0 }, position{ 0 }, nrOfChildren{ 0 }, parent{ -1 }, loader{ nullptr }, node{ nullptr }
+   {}
+};
+
+
+/**
+ * @brief Header of a baked cache file. All the offsets are in bytes from the beginning of the file.
+ */
+struct BakedHeader
+{
+   uint32_t magic;                        ///< File magic ("OVOB")
+   uint32_t version;                      ///< Ovo::bakedVersion
+   uint32_t nrOfTextures;                 ///< Number of entries in the texture table
+   uint32_t nrOfMaterials;                ///< Number of entries in the material table
+   uint32_t nrOfNodes;                    ///< Number of entries in the node table
+   uint32_t nrOfLods;                     ///< Number of entries in the LOD table
+   uint64_t texturesOffset;               ///< Texture table (BakedTexture)
+   uint64_t materialsOffset;              ///< Material table (BakedMaterial)
+   uint64_t nodesOffset;                  ///< Node table (BakedNode), parents before children
+   uint64_t lodsOffset;                   ///< LOD table (BakedLod)
+   uint64_t stringsOffset;                ///< Zero-terminated strings
+   uint64_t stringsSize;                  ///< Size of the strings block
+   uint64_t verticesOffset;               ///< Vertex block (Vbo::VertexData), aligned to Ovo::bakedAlignment
+   uint64_t verticesSize;                 ///< Size of the vertex block
+   uint64_t facesOffset;                  ///< Index block (Ebo::FaceData), aligned to Ovo::bakedAlignment
+   uint64_t facesSize;                    ///< Size of the index block
+};
+
+
+/**
+ * @brief Texture of a baked cache file.
+ */
+struct BakedTexture
+{
+   uint32_t name;                         ///< Image filename (offset in the strings block)
+};
+
+
+/**
+ * @brief Material of a baked cache file.
+ */
+struct BakedMaterial
+{
+   uint32_t name;                         ///< Material name (offset in the strings block)
+   glm::vec3 emission;
+   glm::vec3 albedo;
+   float roughness;
+   float metalness;
+   float opacity;
+   int32_t texture[Eng::Material::maxNrOfTextures];   ///< Albedo, normal, roughness and metalness texture indices (-1 if none)
+};
+
+
+/**
+ * @brief Node, mesh or light of a baked cache file.
+ */
+struct BakedNode
+{
+   uint32_t type;                         ///< Ovo::ChunkId of the original chunk
+   uint32_t name;                         ///< Node name (offset in the strings block)
+   int32_t parent;                        ///< Parent node index (-1 if none)
+   int32_t material;                      ///< Material index (meshes only, -1 if none)
+   glm::mat4 matrix;                      ///< Local matrix
+   glm::vec3 color;                       ///< Light color (lights only)
+   float radius;                          ///< Bounding sphere radius (meshes only)
+   glm::vec3 bboxMin;                     ///< Bounding box minimum corner (meshes only)
+   glm::vec3 bboxMax;                     ///< Bounding box maximum corner (meshes only)
+   uint32_t firstLod;                     ///< First entry in the LOD table (meshes only)
+   uint32_t nrOfLods;                     ///< Number of LODs (meshes only)
+};
+
+
+/**
+ * @brief Level of detail of a baked cache file.
+ */
+struct BakedLod
+{
+   uint64_t vertices;                     ///< Offset in the vertex block, aligned to Ovo::bakedAlignment
+   uint64_t faces;                        ///< Offset in the index block, aligned to Ovo::bakedAlignment
+   uint32_t nrOfVertices;
+   uint32_t nrOfFaces;
+};
+
+
+/**
+ * @brief Header of an index (table of contents) file.
+ */
+struct IndexHeader
+{
+   uint32_t magic;                        ///< File magic ("OVOI")
+   uint32_t version;                      ///< Ovo::indexVersion
+   uint64_t fileSize;                     ///< Size of the indexed OVO file, to detect stale indexes
+   uint64_t fileTime;                     ///< Last write time of the indexed OVO file, to detect stale indexes
+   uint32_t nrOfEntries;                  ///< Number of IndexEntry records
+   uint32_t stringsSize;                  ///< Size of the zero-terminated strings following the records
+};
+
+
+/**
+ * @brief Record of an index file, one per material, node, mesh or light chunk.
+ */
+struct IndexRecord
+{
+   uint32_t chunkId;                      ///< Ovo::ChunkId of the chunk
+   uint32_t name;                         ///< Object name (offset in the strings)
+   uint32_t material;                     ///< Material name (meshes only, offset in the strings)
+   uint32_t padding;
+   uint64_t begin;                        ///< Offset of the chunk
+   uint64_t end;                          ///< End of the chunk and of its whole subtree
+};
+
+
+/**
+ * @brief Entry of a table of contents, in memory.
+ */
+struct IndexEntry
+{
+   uint32_t chunkId;                      ///< Ovo::ChunkId of the chunk
+   std::string name;                      ///< Object name
+   std::string material;                  ///< Material name (meshes only)
+   uint64_t begin;                        ///< Offset of the chunk
+   uint64_t end;                          ///< End of the chunk and of its whole subtree
+};
+
+
+// Baked structures are mapped as is:
+static_assert(sizeof(BakedHeader) == 104 && sizeof(BakedTexture) == 4 && sizeof(BakedMaterial) == 56 &&
+              sizeof(BakedNode) == 128 && sizeof(BakedLod) == 24, "Unexpected baked structure layout");
+static_assert(sizeof(IndexHeader) == 32 && sizeof(IndexRecord) == 32, "Unexpected index structure layout");
+
+
+/**
+ * @brief Ovo::Loading reserved structure.
+ */
+struct Eng::Ovo::Loading::Reserved
+{
+   std::string filename;                        ///< File being loaded
+   Eng::Serializer serial;                      ///< Mapped file (referenced by the decoded objects until attached)
+   std::vector<ChunkEntry> table;               ///< Chunk table
+   std::unique_ptr<std::atomic<bool>[]> decoded;   ///< Per-entry flag, set once the entry is decoded
+
+   std::atomic<Eng::Ovo::Loading::Status> status;  ///< Current status
+   std::atomic<bool> scanned;                   ///< True once the chunk table is available
+   std::atomic<bool> abort;                     ///< Asks the worker threads to stop
+   std::thread thread;                          ///< Background thread (async loading only)
+
+   size_t nrOfAttached;                         ///< Number of entries already attached (main thread only)
+   uint64_t nrOfChunks;                         ///< Pool heap allocations when the loading started
+   uint64_t nrOfAllocations;                    ///< Pool allocations when the loading started
+   std::reference_wrapper<Eng::Node> root;      ///< Root node, once attached
+
+   // Loading steps:
+   bool run();
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : status{ Eng::Ovo::Loading::Status::none }, scanned{ false }, abort{ false },
+                nrOfAttached{ 0 }, nrOfChunks{ 0 }, nrOfAllocations{ 0 }, root{ Eng::Node::empty }
+   {}
+
+
+   /**
+    * Destructor. Stops the background thread (objects not yet attached are released by the main thread).
+    */
+   ~Reserved()
+   {
+      abort = true;
+      if (thread.joinable())
+         thread.join();
+   }
+};
+
+
+
+////////////
+// STATIC //
+////////////
+
+   // Baked cache file magic ("OVOB"):
+   static constexpr uint32_t bakedMagic = 0x424F564F;
+
+   // Index file magic ("OVOI"):
+   static constexpr uint32_t indexMagic = 0x494F564F;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Allocates an empty object for a given chunk type.
+ * @param chunkId chunk ID
+ * @param loader filled with the same object, seen as an OVO loader
+ * @return new object, or nullptr if the chunk ID is not supported
+ */
+static std::unique_ptr<Eng::Object> allocate(uint32_t chunkId, Eng::Ovo *&loader)
+{
+   switch (chunkId)
+   {
+      ///////////////////////////////////////////////////////////
+      case static_cast<uint32_t>(Eng::Ovo::ChunkId::material): //
+      {
+         std::unique_ptr<Eng::Material> mat = std::make_unique<Eng::Material>();
+         loader = mat.get();
+         return mat;
+      }
+
+      ///////////////////////////////////////////////////////
+      case static_cast<uint32_t>(Eng::Ovo::ChunkId::node): //
+      {
+         std::unique_ptr<Eng::Node> node = std::make_unique<Eng::Node>();
+         loader = node.get();
+         return node;
+      }
+
+      ///////////////////////////////////////////////////////
+      case static_cast<uint32_t>(Eng::Ovo::ChunkId::mesh): //
+      {
+         std::unique_ptr<Eng::Mesh> mesh = std::make_unique<Eng::Mesh>();
+         loader = mesh.get();
+         return mesh;
+      }
+
+      ////////////////////////////////////////////////////////
+      case static_cast<uint32_t>(Eng::Ovo::ChunkId::light): //
+      {
+         std::unique_ptr<Eng::Light> light = std::make_unique<Eng::Light>();
+         loader = light.get();
+         return light;
+      }
+   }
+
+   // Not supported:
+   loader = nullptr;
+   return nullptr;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Walks the chunk headers following the version chunk and builds the chunk table, including the hierarchy. Only
+ * the few fields needed to rebuild the hierarchy are read. 
+ * @param serial serial data, positioned after the version chunk
+ * @param table chunk table to fill (in file order)
+ * @param objects when true, an empty object is allocated for each known chunk
+ * @param end offset where to stop (end of data by default)
+ * @return TF
+ */
+static bool prescan(Eng::Serializer &serial, std::vector<ChunkEntry> &table, bool objects = true, 
+                    uint64_t end = std::numeric_limits<uint64_t>::max())
+{
+   // Nodes still waiting for children:
+   struct Open
+   {
+      size_t entry;
+      uint32_t remaining;
+   };
+   std::vector<Open> open;
+
+   while (serial.getPosition() < end && serial.getDataAtCurPos())
+   {
+      ChunkEntry entry;
+      entry.position = serial.getPosition();
+
+      uint32_t chunkSize = 0;
+      if (!serial.deserialize(entry.chunkId) || !serial.deserialize(chunkSize))
+      {
+         ENG_LOG_ERROR("Corrupted chunk found at offset %llu", entry.position);
+         return false;
+      }
+      const uint64_t next = serial.getPosition() + chunkSize;
+      if (next > serial.getNrOfBytes())
+      {
+         ENG_LOG_ERROR("Corrupted chunk found at offset %llu", entry.position);
+         return false;
+      }
+
+      switch (entry.chunkId)
+      {
+         case static_cast<uint32_t>(Eng::Ovo::ChunkId::material):
+         case static_cast<uint32_t>(Eng::Ovo::ChunkId::node):
+         case static_cast<uint32_t>(Eng::Ovo::ChunkId::mesh):
+         case static_cast<uint32_t>(Eng::Ovo::ChunkId::light):
+            if (objects)
+               entry.object = allocate(entry.chunkId, entry.loader);
+            break;
+
+         ///////////
+         default: //
+            ENG_LOG_WARN("Unknown chunk ID (%u) found: ignored", entry.chunkId);
+            serial.setPosition(next);
+            continue;
+      }
+
+      // Hierarchy (materials are never part of it):
+      if (entry.chunkId != static_cast<uint32_t>(Eng::Ovo::ChunkId::material))
+      {
+         // Name, matrix, then number of children:
+         std::string name;
+         serial.deserialize(name);
+         serial.skip(sizeof(glm::mat4));
+         serial.deserialize(entry.nrOfChildren);
+
+         if (!open.empty())
+         {
+            entry.parent = static_cast<int64_t>(open.back().entry);
+            open.back().remaining--;
+            while (!open.empty() && open.back().remaining == 0)
+               open.pop_back();
+         }
+         if (entry.nrOfChildren)
+            open.push_back({ table.size(), entry.nrOfChildren });
+      }
+
+      table.push_back(std::move(entry));
+      serial.setPosition(next);
+   }
+
+   // Done:
+   if (!open.empty())
+      ENG_LOG_WARN("Hierarchy is incomplete");
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Decodes all the chunks of the table in parallel, in deferred mode (no GPU resources are created). Each entry is 
+ * flagged as decoded as soon as it is ready, so that it can be attached while the others are still being decoded.
+ * @param serial serial data (shared by the worker threads)
+ * @param table chunk table built by prescan()
+ * @param decoded per-entry decoded flags
+ * @param abort when set, stops the workers
+ * @return number of threads used
+ */
+static uint32_t decode(const Eng::Serializer &serial, std::vector<ChunkEntry> &table, std::atomic<bool> *decoded, const std::atomic<bool> &abort)
+{
+   std::atomic<size_t> next = 0;
+   auto worker = [&serial, &table, decoded, &abort, &next]()
+   {
+      Eng::Serializer view(serial); // Shares the same memory mapping
+      Eng::Ovo::Mode mode = Eng::Ovo::Mode::deferred;
+      for (size_t c = next++; c < table.size() && !abort; c = next++)
+      {
+         view.setPosition(table[c].position);
+         table[c].loader->loadChunk(view, &mode);
+         decoded[c].store(true, std::memory_order_release);
+      }
+   };
+
+   // Calling thread is one of the workers:
+   const uint32_t nrOfThreads = static_cast<uint32_t>(std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), table.size())));
+   std::vector<std::thread> threads;
+   for (uint32_t c = 1; c < nrOfThreads; c++)
+      threads.emplace_back(worker);
+   worker();
+   for (auto &t : threads)
+      t.join();
+
+   // Done:
+   return nrOfThreads;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Builds the table of contents of an OVO file: the byte range of each chunk together with its whole subtree, and the
+ * material referenced by each mesh. 
+ * @param serial serial data, positioned after the version chunk
+ * @param index table of contents to fill (in file order)
+ * @return TF
+ */
+static bool scanIndex(Eng::Serializer &serial, std::vector<IndexEntry> &index)
+{
+   std::vector<ChunkEntry> table;
+   if (!prescan(serial, table, false))
+      return false;
+
+   // Last descendant of each entry (children always follow their parent):
+   std::vector<size_t> last(table.size());
+   for (size_t c = table.size(); c-- > 0; )
+   {
+      last[c] = std::max(last[c], c);
+      if (table[c].parent >= 0)
+         last[table[c].parent] = std::max(last[table[c].parent], last[c]);
+   }
+
+   index.resize(table.size());
+   for (size_t c = 0; c < table.size(); c++)
+   {
+      IndexEntry &entry = index[c];
+      entry.chunkId = table[c].chunkId;
+      entry.begin = table[c].position;
+      entry.end = last[c] + 1 < table.size() ? table[last[c] + 1].position : serial.getNrOfBytes();
+
+      // Name (always first), then material name for meshes:
+      serial.setPosition(entry.begin + 2 * sizeof(uint32_t));
+      serial.deserialize(entry.name);
+      if (entry.chunkId == static_cast<uint32_t>(Eng::Ovo::ChunkId::mesh))
+      {
+         std::string target;
+         serial.skip(sizeof(glm::mat4) + sizeof(uint32_t));
+         serial.deserialize(target);
+         serial.skip(sizeof(uint8_t));
+         serial.deserialize(entry.material);
+      }
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the last write time of a file, in the native clock units.
+ * @param filename file name
+ * @return last write time, or 0 if not available
+ */
+static uint64_t getFileTime(const std::string &filename)
+{
+   std::error_code error;
+   const auto time = std::filesystem::last_write_time(filename, error);
+   if (error)
+      return 0;
+   return static_cast<uint64_t>(time.time_since_epoch().count());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reads the table of contents stored in an index file.
+ * @param filename index file
+ * @param fileSize size of the indexed OVO file (the index is rejected if it does not match)
+ * @param fileTime last write time of the indexed OVO file (the index is rejected if it does not match)
+ * @param index table of contents to fill
+ * @return TF
+ */
+static bool readIndex(const std::string &filename, uint64_t fileSize, uint64_t fileTime, std::vector<IndexEntry> &index)
+{
+   // Index files are optional:
+   if (!std::ifstream(filename))
+      return false;
+
+   Eng::Serializer serial;
+   if (!serial.map(filename))
+      return false;
+
+   IndexHeader header;
+   if (!serial.deserialize(&header, sizeof(IndexHeader)) || header.magic != indexMagic || 
+       header.version != Eng::Ovo::indexVersion || header.fileSize != fileSize || header.fileTime != fileTime)
+   {
+      ENG_LOG_WARN("Index file '%s' is invalid or outdated: ignored", filename.c_str());
+      return false;
+   }
+
+   const uint64_t stringsOffset = sizeof(IndexHeader) + header.nrOfEntries * sizeof(IndexRecord);
+   if (stringsOffset + header.stringsSize != serial.getNrOfBytes() || header.stringsSize == 0 ||
+       static_cast<const char *>(serial.getData())[serial.getNrOfBytes() - 1] != '\0')
+   {
+      ENG_LOG_WARN("Index file '%s' is corrupted: ignored", filename.c_str());
+      return false;
+   }
+   const IndexRecord *records = static_cast<const IndexRecord *>(serial.getDataAtCurPos());
+   const char *strings = static_cast<const char *>(serial.getData()) + stringsOffset;
+   auto string = [&header, strings](uint32_t offset)
+   {
+      return std::string(strings + std::min(offset, header.stringsSize - 1));
+   };
+
+   index.resize(header.nrOfEntries);
+   for (uint32_t c = 0; c < header.nrOfEntries; c++)
+   {
+      if (records[c].begin >= records[c].end || records[c].end > fileSize)
+      {
+         ENG_LOG_WARN("Index file '%s' is corrupted: ignored", filename.c_str());
+         index.clear();
+         return false;
+      }
+      index[c].chunkId = records[c].chunkId;
+      index[c].name = string(records[c].name);
+      index[c].material = string(records[c].material);
+      index[c].begin = records[c].begin;
+      index[c].end = records[c].end;
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Creates the GPU resources of a decoded entry, moves its object into the container and attaches it to its parent.
+ * Must be called from the main thread, in table order.
+ * @param entry decoded entry
+ * @param table chunk table the entry belongs to
+ * @return attached node, or Node::empty for materials
+ */
+static Eng::Node &attach(ChunkEntry &entry, std::vector<ChunkEntry> &table)
+{
+   Eng::Container &container = Eng::Container::getInstance();
+   entry.loader->upload();
+   container.add(*entry.object);
+   entry.object.reset();
+   entry.loader = nullptr;
+
+   switch (entry.chunkId)
+   {
+      case static_cast<uint32_t>(Eng::Ovo::ChunkId::node):  entry.node = &container.getLastNode(); break;
+      case static_cast<uint32_t>(Eng::Ovo::ChunkId::mesh):  entry.node = &container.getLastMesh(); break;
+      case static_cast<uint32_t>(Eng::Ovo::ChunkId::light): entry.node = &container.getLastLight(); break;
+      default:
+         return Eng::Node::empty;
+   }
+
+   if (entry.parent >= 0)
+      table[entry.parent].node->addChild(*entry.node);
+
+   // Done:
+   return *entry.node;
+}
+
+
+////////////////////////////////
+// BODY OF CLASS Ovo::Loading //
+////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::Ovo::Loading::Loading() : reserved(std::make_unique<Eng::Ovo::Loading::Reserved>())
+{}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Move constructor.
+ */
+ENG_API Eng::Ovo::Loading::Loading(Loading &&other) : reserved(std::move(other.reserved))
+{}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor. A loading still in progress is aborted.
+ */
+ENG_API Eng::Ovo::Loading::~Loading()
+{}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Maps, prescans and decodes the file. Runs either on the thread calling Ovo::load() or on the background thread of 
+ * Ovo::loadAsync().
+ * @return TF
+ */
+bool Eng::Ovo::Loading::Reserved::run()
+{
+   nrOfChunks = Eng::Pool::getNrOfChunks();
+   nrOfAllocations = Eng::Pool::getNrOfAllocations();
+
+   /////////////////////////////////////////
+   // STEP 1: map file into memory (no copy, no size limit)
+   if (!serial.map(filename))
+   {
+      ENG_LOG_ERROR("Unable to open file '%s'", filename.c_str());
+      status = Status::failed;
+      return false;
+   }
+
+   // First chunk must be the format version:
+   Eng::Ovo ovo;
+   if (ovo.loadChunk(serial) == 0)
+   {
+      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", filename.c_str());
+      status = Status::failed;
+      return false;
+   }
+
+
+   /////////////////////////////////////////////
+   // STEP 2: build the chunk table (sequential)
+   if (!prescan(serial, table))
+   {
+      ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
+      status = Status::failed;
+      return false;
+   }
+   decoded = std::make_unique<std::atomic<bool>[]>(table.size());
+   for (size_t c = 0; c < table.size(); c++)
+      decoded[c] = false;
+   scanned.store(true, std::memory_order_release);
+
+
+   /////////////////////////////////////////////
+   // STEP 3: decode all the chunks (in parallel)
+   uint32_t nrOfThreads = decode(serial, table, decoded.get(), abort);
+   ENG_LOG_DEBUG("%llu chunks decoded using %u threads", (uint64_t) table.size(), nrOfThreads);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the current status of the loading.
+ * @return loading status
+ */
+Eng::Ovo::Loading::Status ENG_API Eng::Ovo::Loading::getStatus() const
+{
+   if (!reserved)
+      return Status::none;
+   return reserved->status;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the fraction of objects already attached.
+ * @return value between 0 and 1
+ */
+float ENG_API Eng::Ovo::Loading::getProgress() const
+{
+   if (!reserved || !reserved->scanned.load(std::memory_order_acquire))
+      return 0.0f;
+   if (reserved->table.empty())
+      return 1.0f;
+   return static_cast<float>(reserved->nrOfAttached) / static_cast<float>(reserved->table.size());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the root node. The root node is available as soon as it is attached, while its children keep being added by 
+ * the next update() calls.
+ * @return root node or Node::empty if not available yet
+ */
+Eng::Node ENG_API &Eng::Ovo::Loading::getRoot() const
+{
+   if (!reserved)
+      return Eng::Node::empty;
+   return reserved->root;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Creates the GPU resources of the objects decoded so far and attaches them to the scene graph, in file order. Must be
+ * called from the main thread (typically once per frame). At least one object is processed per call when available.
+ * @param budget time budget in milliseconds
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::Loading::update(float budget)
+{
+   // Safety net:
+   if (!reserved || reserved->status == Status::none)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+   if (reserved->status == Status::failed)
+      return false;
+   if (!reserved->scanned.load(std::memory_order_acquire))
+      return true;
+
+   const auto start = std::chrono::steady_clock::now();
+   std::vector<ChunkEntry> &table = reserved->table;
+   while (reserved->nrOfAttached < table.size() && reserved->decoded[reserved->nrOfAttached].load(std::memory_order_acquire))
+   {
+      ChunkEntry &entry = table[reserved->nrOfAttached++];
+      Eng::Node &node = attach(entry, table);
+      if (entry.parent < 0 && node != Eng::Node::empty)
+         reserved->root = node;
+
+      if (std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() >= budget)
+         break;
+   }
+
+   // All attached?
+   if (reserved->nrOfAttached == table.size())
+   {
+      if (reserved->thread.joinable())
+         reserved->thread.join();
+      reserved->serial.clear();
+      reserved->status = Status::done;
+      ENG_LOG_DEBUG("File '%s' loaded, %llu objects (%llu pooled allocation(s), %llu heap allocation(s))", reserved->filename.c_str(),
+                    (uint64_t) table.size(), Eng::Pool::getNrOfAllocations() - reserved->nrOfAllocations, 
+                    Eng::Pool::getNrOfChunks() - reserved->nrOfChunks);
+   }
+
+   // Done:
+   return true;
+}
+
+
+
 ///////////////////////
 // BODY OF CLASS Ovo //
 ///////////////////////
@@ -32,62 +756,488 @@
  * @param data optional pointer
  * @return version or 0 if error
  */
-uint32_t ENG_API Eng::Ovo::loadChunk(Eng::Serializer &serial, void *data)
+uint32_t ENG_API Eng::Ovo::loadChunk(Eng::Serializer &serial, void *data)
+{
+   uint32_t chunkId;
+   serial.deserialize(chunkId);
+
+   if (chunkId != static_cast<uint32_t>(Ovo::ChunkId::version))
+   {
+      ENG_LOG_ERROR("Invalid chunk ID found");
+      return 0;
+   }   
+   
+   uint32_t chunkSize;
+   serial.deserialize(chunkSize);
+
+   uint32_t version;
+   serial.deserialize(version);
+   if (version != Ovo::version)
+   {
+      ENG_LOG_ERROR("Invalid format version");
+      return 0;
+   }   
+
+   // Done:   
+   return version;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Creates the GPU resources of an object loaded in deferred mode. In its base class, there is nothing to create.
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::upload()
+{
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Discards the current chunk and updates the serializer to the next chunk.
+ * @param serializer serial data
+ * @return size of the ignored chunk
+ */
+uint32_t ENG_API Eng::Ovo::ignoreChunk(Eng::Serializer &serial)
+{
+   uint32_t chunkId;
+   serial.deserialize(chunkId);
+   
+   uint32_t chunkSize;
+   serial.deserialize(chunkSize);   
+
+   serial.skip(chunkSize);
+
+   // Done:   
+   return chunkSize;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Saves the specific information of a given object as a new chunk. In its base class, this function writes the file 
+ * version chunk.
+ * @param serial serial data
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::saveChunk(Eng::Serializer &serial) const
+{
+   const uint64_t start = beginChunk(serial, ChunkId::version);
+   serial.serialize(Ovo::version);
+
+   // Done:
+   return endChunk(serial, start);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Writes a chunk header with a temporary size, to be fixed by endChunk().
+ * @param serial serial data
+ * @param chunkId ID of the chunk
+ * @return position of the chunk header
+ */
+uint64_t ENG_API Eng::Ovo::beginChunk(Eng::Serializer &serial, ChunkId chunkId)
+{
+   const uint64_t start = serial.getPosition();
+   serial.serialize(static_cast<uint32_t>(chunkId));
+   serial.serialize(static_cast<uint32_t>(0));
+
+   // Done:
+   return start;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Completes a chunk started by beginChunk() by patching its size.
+ * @param serial serial data
+ * @param start position returned by beginChunk()
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::endChunk(Eng::Serializer &serial, uint64_t start)
+{
+   const uint64_t end = serial.getPosition();
+   const uint64_t chunkSize = end - start - 2 * sizeof(uint32_t);
+   if (end < start + 2 * sizeof(uint32_t) || chunkSize > std::numeric_limits<uint32_t>::max())
+   {
+      ENG_LOG_ERROR("Invalid chunk size");
+      return false;
+   }
+
+   serial.setPosition(start + sizeof(uint32_t));
+   serial.serialize(static_cast<uint32_t>(chunkSize));
+   serial.setPosition(end);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Saves a hierarchy as an OVO file. The materials used by the meshes are written first, followed by the nodes in 
+ * depth-first order, each one through its own saveChunk().
+ * @param root root node of the hierarchy to save
+ * @param filename destination file
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::save(const Eng::Node &root, const std::string &filename)
 {
-   uint32_t chunkId;
-   serial.deserialize(chunkId);
+   // Safety net:
+   if (root == Eng::Node::empty || filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
 
-   if (chunkId != static_cast<uint32_t>(Ovo::ChunkId::version))
+   // Gather nodes and the materials they use (each once):
+   std::vector<const Eng::Node *> nodes;
+   std::vector<const Eng::Material *> materials;
+   std::vector<const Eng::Node *> stack = { &root };
+   while (!stack.empty())
    {
-      ENG_LOG_ERROR("Invalid chunk ID found");
-      return 0;
-   }   
-   
-   uint32_t chunkSize;
-   serial.deserialize(chunkSize);
+      const Eng::Node *node = stack.back();
+      stack.pop_back();
+      nodes.push_back(node);
 
-   uint32_t version;
-   serial.deserialize(version);
-   if (version != Ovo::version)
+      const Eng::Mesh *mesh = node->is<Eng::Mesh>() ? &node->as<Eng::Mesh>() : nullptr;
+      if (mesh && mesh->getMaterial() != Eng::Material::empty &&
+          std::find(materials.begin(), materials.end(), &mesh->getMaterial()) == materials.end())
+         materials.push_back(&mesh->getMaterial());
+
+      const auto &children = node->getListOfChildren();
+      for (auto c = children.rbegin(); c != children.rend(); ++c)
+         stack.push_back(&c->get());
+   }
+
+   // Write chunks:
+   Eng::Serializer serial;
+   bool success = Eng::Ovo::saveChunk(serial);
+   for (auto material : materials)
+      success = success && material->saveChunk(serial);
+   for (auto node : nodes)
+      success = success && node->saveChunk(serial);
+   if (!success)
    {
-      ENG_LOG_ERROR("Invalid format version");
-      return 0;
-   }   
+      ENG_LOG_ERROR("Unable to serialize '%s'", root.getName().c_str());
+      return false;
+   }
 
-   // Done:   
-   return version;
+   // Done:
+   return serial.save(filename);
 }
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Discards the current chunk and updates the serializer to the next chunk.
- * @param serializer serial data
- * @return size of the ignored chunk
+ * Loads an OVO file.
+ * @param filename 3D file 
+ * @return root node or Node::empty if error
  */
-uint32_t ENG_API Eng::Ovo::ignoreChunk(Eng::Serializer &serial)
+Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename)
 {
-   uint32_t chunkId;
-   serial.deserialize(chunkId);
-   
-   uint32_t chunkSize;
-   serial.deserialize(chunkSize);   
+   // Safety net:
+   if (filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return Eng::Node::empty;
+   }
 
-   std::vector<uint8_t> dummy(chunkSize);
-   serial.deserialize(dummy.data(), chunkSize);
+   // Decode on this thread, then attach everything at once:
+   Loading loading;
+   loading.reserved->filename = filename;
+   loading.reserved->status = Loading::Status::loading;
+   if (!loading.reserved->run())
+      return Eng::Node::empty;
+   loading.update(std::numeric_limits<float>::infinity());
 
    // Done:   
-   return chunkSize;
+   return loading.getRoot();
 }
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Loads an OVO file.
+ * Loads an OVO file in background. The returned handle must be updated once per frame from the main thread, which
+ * creates the GPU resources and progressively attaches the loaded nodes to the scene graph.
  * @param filename 3D file 
+ * @return loading handle (with Status::failed if error)
+ */
+Eng::Ovo::Loading ENG_API Eng::Ovo::loadAsync(const std::string &filename)
+{
+   Loading loading;
+
+   // Safety net:
+   if (filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      loading.reserved->status = Loading::Status::failed;
+      return loading;
+   }
+
+   // Start background thread:
+   Loading::Reserved &r = *loading.reserved;
+   r.filename = filename;
+   r.status = Loading::Status::loading;
+   r.thread = std::thread([&r]() { r.run(); });
+
+   // Done:
+   return loading;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Converts an OVO file into a baked cache, to be loaded with loadBaked(). The hierarchy is flattened into a node table
+ * (parents first), material to texture references are resolved to indices, and all the LODs are copied into a vertex 
+ * and an index block, each LOD aligned to Ovo::bakedAlignment so that it can be passed as is to the GPU.
+ * @param input OVO file
+ * @param output baked cache file
+ * @param optimize when true, LODs are reordered for the vertex cache and fetch locality (see Mesh::optimize())
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::bake(const std::string &input, const std::string &output, bool optimize)
+{
+   // Safety net:
+   if (input.empty() || output.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   Eng::Serializer serial;
+   if (!serial.map(input))
+   {
+      ENG_LOG_ERROR("Unable to open file '%s'", input.c_str());
+      return false;
+   }
+   if (Eng::Ovo::loadChunk(serial) == 0)
+   {
+      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", input.c_str());
+      return false;
+   }
+
+   std::vector<ChunkEntry> table;
+   if (!prescan(serial, table, false))
+   {
+      ENG_LOG_ERROR("File '%s' is corrupted", input.c_str());
+      return false;
+   }
+
+   // Tables and blocks:
+   std::string strings;
+   std::vector<BakedTexture> textures;
+   std::vector<BakedMaterial> materials;
+   std::vector<BakedNode> nodes;
+   std::vector<BakedLod> lods;
+   std::vector<uint8_t> vertices, faces;
+   std::map<std::string, int32_t> textureIds, materialIds;
+   std::vector<int32_t> nodeIds(table.size(), -1);
+
+   auto addString = [&strings](const std::string &text)
+   {
+      const uint32_t offset = static_cast<uint32_t>(strings.size());
+      strings.append(text);
+      strings.push_back('\0');
+      return offset;
+   };
+   auto align = [](uint64_t value)
+   {
+      return (value + Eng::Ovo::bakedAlignment - 1) & ~(Eng::Ovo::bakedAlignment - 1);
+   };
+
+   for (size_t c = 0; c < table.size(); c++)
+   {
+      const ChunkEntry &entry = table[c];
+      serial.setPosition(entry.position + 2 * sizeof(uint32_t)); // Skip chunk header
+      std::string name;
+
+      // Materials:
+      if (entry.chunkId == static_cast<uint32_t>(Eng::Ovo::ChunkId::material))
+      {
+         BakedMaterial mat;
+         serial.deserialize(name);
+         mat.name = addString(name);
+         materialIds[name] = static_cast<int32_t>(materials.size());
+
+         serial.deserialize(mat.emission);
+         serial.deserialize(mat.albedo);
+         serial.deserialize(mat.roughness);
+         serial.deserialize(mat.metalness);
+         serial.deserialize(mat.opacity);
+
+         // Albedo, normal, height (ignored), roughness, metalness:
+         const int32_t slots[] = { 0, 1, -1, 2, 3 };
+         for (auto slot : slots)
+         {
+            serial.deserialize(name);
+            if (slot < 0)
+               continue;
+
+            mat.texture[slot] = -1;
+            if (name == "[none]")
+               continue;
+
+            auto it = textureIds.find(name);
+            if (it == textureIds.end())
+            {
+               it = textureIds.emplace(name, static_cast<int32_t>(textures.size())).first;
+               textures.push_back({ addString(name) });
+            }
+            mat.texture[slot] = it->second;
+         }
+         materials.push_back(mat);
+         continue;
+      }
+
+      // Nodes, meshes and lights:
+      BakedNode node;
+      node.type = entry.chunkId;
+      serial.deserialize(name);
+      node.name = addString(name);
+      serial.deserialize(node.matrix);
+      serial.skip(sizeof(uint32_t)); // Number of children
+      serial.deserialize(name);      // Target
+      node.parent = entry.parent >= 0 ? nodeIds[entry.parent] : -1;
+      node.material = -1;
+      node.color = glm::vec3(1.0f);
+      node.radius = 0.0f;
+      node.bboxMin = glm::vec3(0.0f);
+      node.bboxMax = glm::vec3(0.0f);
+      node.firstLod = static_cast<uint32_t>(lods.size());
+      node.nrOfLods = 0;
+
+      switch (entry.chunkId)
+      {
+         ///////////////////////////////////////////////////////
+         case static_cast<uint32_t>(Eng::Ovo::ChunkId::mesh): //
+         {
+            serial.skip(sizeof(uint8_t)); // Subtype
+            serial.deserialize(name);
+            auto it = materialIds.find(name);
+            if (it != materialIds.end())
+               node.material = it->second;
+
+            serial.deserialize(node.radius);
+            serial.deserialize(node.bboxMin);
+            serial.deserialize(node.bboxMax);
+
+            uint8_t hasPhysics;
+            serial.deserialize(hasPhysics);
+            if (hasPhysics)
+            {
+               ENG_LOG_ERROR("Physics section not supported");
+               return false;
+            }
+
+            serial.deserialize(node.nrOfLods);
+            for (uint32_t l = 0; l < node.nrOfLods; l++)
+            {
+               BakedLod lod;
+               serial.deserialize(lod.nrOfVertices);
+               serial.deserialize(lod.nrOfFaces);
+
+               const uint64_t verticesSize = lod.nrOfVertices * sizeof(Eng::Vbo::VertexData);
+               const uint64_t facesSize = lod.nrOfFaces * sizeof(Eng::Ebo::FaceData);
+               const uint8_t *lodVertices = serial.readSpan<uint8_t>(verticesSize);
+               const uint8_t *lodFaces = serial.readSpan<uint8_t>(facesSize);
+               if (lodVertices == nullptr || lodFaces == nullptr)
+                  return false;
+
+               lod.vertices = align(vertices.size());
+               vertices.resize(lod.vertices);
+               vertices.insert(vertices.end(), lodVertices, lodVertices + verticesSize);
+
+               lod.faces = align(faces.size());
+               faces.resize(lod.faces);
+               faces.insert(faces.end(), lodFaces, lodFaces + facesSize);
+
+               // Optimize the copies:
+               if (optimize)
+               {
+                  ENG_LOG_PLAIN("Mesh: %s, LOD: %u", strings.c_str() + node.name, l + 1);
+                  if (!Eng::Mesh::optimize(lod.nrOfVertices, reinterpret_cast<Eng::Vbo::VertexData *>(vertices.data() + lod.vertices),
+                                           lod.nrOfFaces, reinterpret_cast<Eng::Ebo::FaceData *>(faces.data() + lod.faces)))
+                     return false;
+               }
+
+               lods.push_back(lod);
+            }
+         }
+         break;
+
+         ////////////////////////////////////////////////////////
+         case static_cast<uint32_t>(Eng::Ovo::ChunkId::light): //
+            serial.skip(sizeof(uint8_t)); // Subtype
+            serial.deserialize(node.color);
+            break;
+      }
+
+      nodeIds[c] = static_cast<int32_t>(nodes.size());
+      nodes.push_back(node);
+   }
+
+   // Layout:
+   BakedHeader header;
+   header.magic = bakedMagic;
+   header.version = Eng::Ovo::bakedVersion;
+   header.nrOfTextures = static_cast<uint32_t>(textures.size());
+   header.nrOfMaterials = static_cast<uint32_t>(materials.size());
+   header.nrOfNodes = static_cast<uint32_t>(nodes.size());
+   header.nrOfLods = static_cast<uint32_t>(lods.size());
+   header.texturesOffset = sizeof(BakedHeader);
+   header.materialsOffset = header.texturesOffset + textures.size() * sizeof(BakedTexture);
+   header.nodesOffset = header.materialsOffset + materials.size() * sizeof(BakedMaterial);
+   header.lodsOffset = header.nodesOffset + nodes.size() * sizeof(BakedNode);
+   header.stringsOffset = header.lodsOffset + lods.size() * sizeof(BakedLod);
+   header.stringsSize = strings.size();
+   header.verticesOffset = align(header.stringsOffset + header.stringsSize);
+   header.verticesSize = vertices.size();
+   header.facesOffset = align(header.verticesOffset + header.verticesSize);
+   header.facesSize = faces.size();
+
+   // Write file:
+   std::ofstream file(output, std::ios::binary);
+   if (!file)
+   {
+      ENG_LOG_ERROR("Unable to create file '%s'", output.c_str());
+      return false;
+   }
+
+   const char padding[Eng::Ovo::bakedAlignment] = {};
+   file.write(reinterpret_cast<const char *>(&header), sizeof(BakedHeader));
+   file.write(reinterpret_cast<const char *>(textures.data()), textures.size() * sizeof(BakedTexture));
+   file.write(reinterpret_cast<const char *>(materials.data()), materials.size() * sizeof(BakedMaterial));
+   file.write(reinterpret_cast<const char *>(nodes.data()), nodes.size() * sizeof(BakedNode));
+   file.write(reinterpret_cast<const char *>(lods.data()), lods.size() * sizeof(BakedLod));
+   file.write(strings.data(), strings.size());
+   file.write(padding, header.verticesOffset - (header.stringsOffset + header.stringsSize));
+   file.write(reinterpret_cast<const char *>(vertices.data()), vertices.size());
+   file.write(padding, header.facesOffset - (header.verticesOffset + header.verticesSize));
+   file.write(reinterpret_cast<const char *>(faces.data()), faces.size());
+   if (!file)
+   {
+      ENG_LOG_ERROR("Unable to write file '%s'", output.c_str());
+      return false;
+   }
+
+   // Done:
+   ENG_LOG_DEBUG("File '%s' baked into '%s' (%u nodes, %u LODs)", input.c_str(), output.c_str(), header.nrOfNodes, header.nrOfLods);
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Loads a baked cache created by bake(). The file is mapped and its tables used in place: vertex and index data are
+ * passed straight from the mapping to the GPU, and no chunk parsing or name lookup is required.
+ * @param filename baked cache file
  * @return root node or Node::empty if error
  */
-Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename)
+Eng::Node ENG_API &Eng::Ovo::loadBaked(const std::string &filename)
 {
    // Safety net:
    if (filename.empty())
@@ -96,119 +1246,364 @@ Eng::Node ENG_API &Eng::Ovo::load(const std::string &filename)
       return Eng::Node::empty;
    }
 
-
-   /////////////////////////////////////////
-   // STEP 1: load file into a memory buffer
-   bool error = false;
-   FILE *dat = fopen(filename.c_str(), "rb");
-   if (dat == nullptr)
+   Eng::Serializer serial;
+   if (!serial.map(filename))
    {
       ENG_LOG_ERROR("Unable to open file '%s'", filename.c_str());
       return Eng::Node::empty;
    }
 
-   // Get file length (max 2 GB):
-   uint64_t length;
-   fseek(dat, 0L, SEEK_END);
-      length = ftell(dat);
-   fseek(dat, 0L, SEEK_SET);
-
-   // Init mem and copy:
-   Eng::Serializer serial(nullptr, length);
-   if (fread(serial.getData(), sizeof(uint8_t), length, dat) != length)
+   BakedHeader header;
+   if (!serial.deserialize(&header, sizeof(BakedHeader)) || header.magic != bakedMagic || header.version != Eng::Ovo::bakedVersion)
    {
-      ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
-      fclose(dat);
+      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", filename.c_str());
       return Eng::Node::empty;
    }
-   fclose(dat);  
 
-   // First chunk must be the format version:   
-   if (loadChunk(serial) == 0)
+   // Check that all the blocks are within the file:
+   const uint64_t nrOfBytes = serial.getNrOfBytes();
+   auto inside = [nrOfBytes](uint64_t offset, uint64_t size)
    {
-      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", filename.c_str());
+      return offset <= nrOfBytes && size <= nrOfBytes - offset;
+   };
+   const uint8_t *data = static_cast<const uint8_t *>(serial.getData());
+   if (!inside(header.texturesOffset, header.nrOfTextures * sizeof(BakedTexture)) ||
+       !inside(header.materialsOffset, header.nrOfMaterials * sizeof(BakedMaterial)) ||
+       !inside(header.nodesOffset, header.nrOfNodes * sizeof(BakedNode)) ||
+       !inside(header.lodsOffset, header.nrOfLods * sizeof(BakedLod)) ||
+       !inside(header.stringsOffset, header.stringsSize) || header.stringsSize == 0 ||
+       data[header.stringsOffset + header.stringsSize - 1] != '\0' ||
+       !inside(header.verticesOffset, header.verticesSize) ||
+       !inside(header.facesOffset, header.facesSize))
+   {
+      ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
       return Eng::Node::empty;
    }
-   
 
-   ///////////////////////////////
-   // STEP 2: Materials and geoms:  
+   const BakedTexture *textures = reinterpret_cast<const BakedTexture *>(data + header.texturesOffset);
+   const BakedMaterial *materials = reinterpret_cast<const BakedMaterial *>(data + header.materialsOffset);
+   const BakedNode *nodes = reinterpret_cast<const BakedNode *>(data + header.nodesOffset);
+   const BakedLod *lods = reinterpret_cast<const BakedLod *>(data + header.lodsOffset);
+   const char *strings = reinterpret_cast<const char *>(data + header.stringsOffset);
+   auto string = [&header, strings](uint32_t offset)
+   {
+      return offset < header.stringsSize ? strings + offset : "";
+   };
+
    Eng::Container &container = Eng::Container::getInstance();
-   std::function<Eng::Node& (void)> parse;
-   parse = [&serial, &container, this, &parse, &error](void)->Eng::Node&
+
+
+   ///////////////
+   // Textures:
+   std::vector<std::reference_wrapper<const Eng::Texture>> textureRefs(header.nrOfTextures, Eng::Texture::empty);
+   for (uint32_t c = 0; c < header.nrOfTextures; c++)
    {
-      switch (*(static_cast<uint8_t *>(serial.getDataAtCurPos())))
+      Eng::Bitmap bitmap;
+      if (!bitmap.load(string(textures[c].name)))
       {
-         ///////////////////////////////////////////////////////////
-         case static_cast<uint32_t>(Eng::Ovo::ChunkId::material): //
-         {
-            ENG_LOG_DEBUG("Processing material...");
+         ENG_LOG_ERROR("Unable to load image file '%s'", string(textures[c].name));
+         continue;
+      }
+      container.add(bitmap);
 
-            Eng::Material mat;
-            mat.loadChunk(serial);
-            container.add(mat);
-            return Eng::Node::empty;            
-         }
-         break;
+      Eng::Texture tex;
+      tex.load(container.getLastBitmap());
+      tex.setName(container.getLastBitmap().getName()); // Keeps the file name, for saving
+      container.add(tex);
+      textureRefs[c] = container.getLastTexture();
+   }
+
+
+   ////////////////
+   // Materials:
+   const Eng::Texture::Type types[Eng::Material::maxNrOfTextures] = { Eng::Texture::Type::albedo, Eng::Texture::Type::normal, 
+                                                                       Eng::Texture::Type::roughness, Eng::Texture::Type::metalness };
+   std::vector<std::reference_wrapper<const Eng::Material>> materialRefs;
+   materialRefs.reserve(header.nrOfMaterials);
+   for (uint32_t c = 0; c < header.nrOfMaterials; c++)
+   {
+      const BakedMaterial &baked = materials[c];
+      Eng::Material mat;
+      mat.setName(string(baked.name));
+      mat.setEmission(baked.emission);
+      mat.setAlbedo(baked.albedo);
+      mat.setRoughness(baked.roughness);
+      mat.setMetalness(baked.metalness);
+      mat.setOpacity(baked.opacity);
+      for (uint32_t t = 0; t < Eng::Material::maxNrOfTextures; t++)
+         if (baked.texture[t] >= 0 && static_cast<uint32_t>(baked.texture[t]) < header.nrOfTextures)
+            mat.setTexture(textureRefs[baked.texture[t]], types[t]);
+
+      container.add(mat);
+      materialRefs.push_back(container.getLastMaterial());
+   }
+
+
+   ////////////
+   // Nodes:
+   std::vector<std::reference_wrapper<Eng::Node>> nodeRefs;
+   nodeRefs.reserve(header.nrOfNodes);
+   std::reference_wrapper<Eng::Node> root(Eng::Node::empty);
+   for (uint32_t c = 0; c < header.nrOfNodes; c++)
+   {
+      const BakedNode &baked = nodes[c];
+      if (baked.parent >= static_cast<int32_t>(c))
+      {
+         ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
+         return Eng::Node::empty;
+      }
 
+      switch (baked.type)
+      {
          ///////////////////////////////////////////////////////
          case static_cast<uint32_t>(Eng::Ovo::ChunkId::node): //
          {
-            ENG_LOG_DEBUG("Processing node...");
-
             Eng::Node node;
-            uint32_t nrOfChildren = node.loadChunk(serial);            
+            node.setName(string(baked.name)); // Matrix not used, as in Node::loadChunk()
             container.add(node);
-            std::reference_wrapper<Eng::Node> _node = container.getLastNode();
-            while (_node.get().getNrOfChildren() < nrOfChildren)
-               _node.get().addChild(parse());              
-            return _node;
+            nodeRefs.push_back(container.getLastNode());
          }
          break;
 
          ///////////////////////////////////////////////////////
          case static_cast<uint32_t>(Eng::Ovo::ChunkId::mesh): //
          {
-            ENG_LOG_DEBUG("Processing mesh...");
-
             Eng::Mesh mesh;
-            uint32_t nrOfChildren = mesh.loadChunk(serial);            
+            mesh.setName(string(baked.name));
+            mesh.setMatrix(baked.matrix);
+            mesh.setRadius(baked.radius);
+            mesh.setBoundingBox(baked.bboxMin, baked.bboxMax);
+            if (baked.material >= 0 && static_cast<uint32_t>(baked.material) < header.nrOfMaterials)
+               mesh.setMaterial(materialRefs[baked.material]);
+
+            for (uint32_t l = baked.firstLod; l < baked.firstLod + baked.nrOfLods && l < header.nrOfLods; l++)
+            {
+               const BakedLod &lod = lods[l];
+               const uint64_t verticesSize = lod.nrOfVertices * sizeof(Eng::Vbo::VertexData);
+               const uint64_t facesSize = lod.nrOfFaces * sizeof(Eng::Ebo::FaceData);
+               if (lod.vertices > header.verticesSize || verticesSize > header.verticesSize - lod.vertices ||
+                   lod.faces > header.facesSize || facesSize > header.facesSize - lod.faces)
+               {
+                  ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
+                  return Eng::Node::empty;
+               }
+               mesh.addLod(lod.nrOfVertices, data + header.verticesOffset + lod.vertices,
+                           lod.nrOfFaces, data + header.facesOffset + lod.faces);
+            }
+
             container.add(mesh);
-            std::reference_wrapper<Eng::Mesh> _mesh = container.getLastMesh();
-            while (_mesh.get().getNrOfChildren() < nrOfChildren)
-               _mesh.get().addChild(parse());              
-            return _mesh;
+            nodeRefs.push_back(container.getLastMesh());
          }
          break;
 
          ////////////////////////////////////////////////////////
          case static_cast<uint32_t>(Eng::Ovo::ChunkId::light): //
          {
-            ENG_LOG_DEBUG("Processing light...");
-
             Eng::Light light;
-            uint32_t nrOfChildren = light.loadChunk(serial);
+            light.setName(string(baked.name));
+            light.setMatrix(baked.matrix);
+            light.setColor(baked.color);
             container.add(light);
-            std::reference_wrapper<Eng::Light> _light = container.getLastLight();
-            while (_light.get().getNrOfChildren() < nrOfChildren)
-               _light.get().addChild(parse());              
-            return _light;
+            nodeRefs.push_back(container.getLastLight());
          }
          break;
 
          ///////////
          default: //
-            ENG_LOG_WARN("Unknown chunk ID (%u) found: ignored", *(static_cast<uint32_t *>(serial.getDataAtCurPos())));
-            ignoreChunk(serial);
+            ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
             return Eng::Node::empty;
       }
-   };
 
-   // Iterate:
-   std::reference_wrapper<Eng::Node> root(Eng::Node::empty);
-   while (serial.getDataAtCurPos() && !error)
-      root = parse();
+      // Hierarchy:
+      if (baked.parent >= 0)
+         nodeRefs[baked.parent].get().addChild(nodeRefs.back());
+      else
+         root = nodeRefs.back();
+   }
 
-   // Done:   
+   // Done:
    return root;
 }
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Builds the index (table of contents) of an OVO file and stores it in a sidecar file, named after the OVO file with 
+ * an additional ".toc" extension. The index maps each object name to the byte range of its chunk and subtree, and 
+ * is used by loadSubtree() to avoid scanning the whole file.
+ * @param filename OVO file
+ * @return TF
+ */
+bool ENG_API Eng::Ovo::buildIndex(const std::string &filename)
+{
+   // Safety net:
+   if (filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   Eng::Serializer serial;
+   if (!serial.map(filename))
+   {
+      ENG_LOG_ERROR("Unable to open file '%s'", filename.c_str());
+      return false;
+   }
+   if (Eng::Ovo::loadChunk(serial) == 0)
+   {
+      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", filename.c_str());
+      return false;
+   }
+
+   std::vector<IndexEntry> index;
+   if (!scanIndex(serial, index))
+   {
+      ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
+      return false;
+   }
+
+   // Records and strings:
+   std::string strings(1, '\0'); // Offset 0 is the empty string
+   auto addString = [&strings](const std::string &text)
+   {
+      if (text.empty())
+         return 0u;
+      const uint32_t offset = static_cast<uint32_t>(strings.size());
+      strings.append(text);
+      strings.push_back('\0');
+      return offset;
+   };
+
+   std::vector<IndexRecord> records(index.size());
+   for (size_t c = 0; c < index.size(); c++)
+   {
+      records[c].chunkId = index[c].chunkId;
+      records[c].name = addString(index[c].name);
+      records[c].material = addString(index[c].material);
+      records[c].padding = 0;
+      records[c].begin = index[c].begin;
+      records[c].end = index[c].end;
+   }
+
+   IndexHeader header;
+   header.magic = indexMagic;
+   header.version = Eng::Ovo::indexVersion;
+   header.fileSize = serial.getNrOfBytes();
+   header.fileTime = getFileTime(filename);
+   header.nrOfEntries = static_cast<uint32_t>(records.size());
+   header.stringsSize = static_cast<uint32_t>(strings.size());
+
+   // Write file:
+   const std::string indexFilename = filename + ".toc";
+   std::ofstream file(indexFilename, std::ios::binary);
+   file.write(reinterpret_cast<const char *>(&header), sizeof(IndexHeader));
+   file.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(IndexRecord));
+   file.write(strings.data(), strings.size());
+   if (!file)
+   {
+      ENG_LOG_ERROR("Unable to write file '%s'", indexFilename.c_str());
+      return false;
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Loads only the subtree starting at a given node, plus the materials its meshes reference (unless already loaded). 
+ * Chunks are located through the index built by buildIndex() when available and up to date, or by scanning the chunk 
+ * headers otherwise. The subtree root is returned detached, with its own local matrix.
+ * @param filename OVO file
+ * @param nodeName name of the subtree root node
+ * @return subtree root node or Node::empty if error
+ */
+Eng::Node ENG_API &Eng::Ovo::loadSubtree(const std::string &filename, const std::string &nodeName)
+{
+   // Safety net:
+   if (filename.empty() || nodeName.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return Eng::Node::empty;
+   }
+
+   Loading loading;
+   Loading::Reserved &r = *loading.reserved;
+   r.filename = filename;
+   if (!r.serial.map(filename))
+   {
+      ENG_LOG_ERROR("Unable to open file '%s'", filename.c_str());
+      return Eng::Node::empty;
+   }
+   if (Eng::Ovo::loadChunk(r.serial) == 0)
+   {
+      ENG_LOG_ERROR("Invalid format version or wrong file format for file '%s'", filename.c_str());
+      return Eng::Node::empty;
+   }
+
+   // Table of contents:
+   std::vector<IndexEntry> index;
+   if (!readIndex(filename + ".toc", r.serial.getNrOfBytes(), getFileTime(filename), index) && !scanIndex(r.serial, index))
+   {
+      ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
+      return Eng::Node::empty;
+   }
+
+   auto node = std::find_if(index.begin(), index.end(), [&nodeName](const IndexEntry &entry)
+   {
+      return entry.chunkId != static_cast<uint32_t>(Eng::Ovo::ChunkId::material) && entry.name == nodeName;
+   });
+   if (node == index.end())
+   {
+      ENG_LOG_ERROR("Node '%s' not found in file '%s'", nodeName.c_str(), filename.c_str());
+      return Eng::Node::empty;
+   }
+
+
+   ///////////////////////////////////////////////////////////
+   // Build the chunk table: missing materials, then subtree
+   Eng::Container &container = Eng::Container::getInstance();
+   std::vector<std::string> materials;
+   for (auto &entry : index)
+      if (entry.begin >= node->begin && entry.end <= node->end && !entry.material.empty() &&
+          std::find(materials.begin(), materials.end(), entry.material) == materials.end())
+         materials.push_back(entry.material);
+
+   for (auto &material : materials)
+   {
+      if (container.find<Eng::Material>(material) != Eng::Material::empty)
+         continue;
+
+      for (auto &entry : index)
+         if (entry.chunkId == static_cast<uint32_t>(Eng::Ovo::ChunkId::material) && entry.name == material)
+         {
+            if (!r.serial.setPosition(entry.begin) || !prescan(r.serial, r.table, true, entry.end))
+            {
+               ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
+               return Eng::Node::empty;
+            }
+            break;
+         }
+   }
+
+   if (!r.serial.setPosition(node->begin) || !prescan(r.serial, r.table, true, node->end))
+   {
+      ENG_LOG_ERROR("File '%s' is corrupted", filename.c_str());
+      return Eng::Node::empty;
+   }
+
+
+   //////////////////////////////////
+   // Decode, then attach everything
+   r.decoded = std::make_unique<std::atomic<bool>[]>(r.table.size());
+   for (size_t c = 0; c < r.table.size(); c++)
+      r.decoded[c] = false;
+   r.scanned = true;
+   r.status = Loading::Status::loading;
+   decode(r.serial, r.table, r.decoded.get(), r.abort);
+   loading.update(std::numeric_limits<float>::infinity());
+
+   // Done:
+   return loading.getRoot();
+}
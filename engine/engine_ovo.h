@@ -28,6 +28,9 @@ public: //
 
    // Consts:
    static constexpr uint32_t version = 8;       ///< OVO format revision (divide by 10)   
+   static constexpr uint32_t bakedVersion = 2;  ///< Baked cache format revision
+   static constexpr uint64_t bakedAlignment = 256; ///< Alignment of the baked vertex and index blocks, in bytes
+   static constexpr uint32_t indexVersion = 2;  ///< Index (table of contents) format revision
 
 
    /**
@@ -46,9 +49,99 @@ public: //
    };
 
 
+   /**
+    * @brief Chunk loading modes, passed to loadChunk() through its optional data pointer.
+    */
+   enum class Mode : uint32_t
+   {
+      immediate,     ///< Parse the chunk and create its GPU resources at once (default)
+      deferred,      ///< Only parse the chunk (thread-safe): GPU resources are created by upload() on the main thread
+
+      // Terminator:
+      last
+   };
+
+
+   /**
+    * @brief Handle of a file loaded in background by loadAsync(). Objects are decoded by worker threads, while their
+    *        GPU resources are created and the nodes attached to the scene graph by update(), on the main thread.
+    */
+   class ENG_API Loading
+   {
+   //////////
+   public: //
+   //////////
+
+      /**
+       * @brief Status of the loading.
+       */
+      enum class Status : uint32_t
+      {
+         none,          ///< Not started
+         loading,       ///< Still decoding or waiting for update()
+         done,          ///< All the objects are attached
+         failed,        ///< Loading aborted because of an error
+
+         // Terminator:
+         last
+      };
+
+      // Const/dest:
+      Loading();
+      Loading(Loading &&other);
+      Loading(Loading const &) = delete;
+      ~Loading();
+
+      // Operators:
+      void operator=(Loading const &) = delete;
+
+      // Get/set:
+      Status getStatus() const;
+      float getProgress() const;
+      Eng::Node &getRoot() const;
+
+      // Management:
+      bool update(float budget = 2.0f);
+
+
+   ///////////
+   private: //
+   ///////////
+
+      // Reserved:
+      struct Reserved;
+      std::unique_ptr<Reserved> reserved;
+
+      friend class Ovo;
+   };
+
+
    // Loading methods:
    Eng::Node &load(const std::string &filename);
+   Loading loadAsync(const std::string &filename);
    virtual uint32_t loadChunk(Eng::Serializer &serial, void *data = nullptr);
+   virtual bool upload();
    uint32_t ignoreChunk(Eng::Serializer &serial);
+
+   // Index (table of contents):
+   bool buildIndex(const std::string &filename);
+   Eng::Node &loadSubtree(const std::string &filename, const std::string &nodeName);
+
+   // Saving methods:
+   bool save(const Eng::Node &root, const std::string &filename);
+   virtual bool saveChunk(Eng::Serializer &serial) const;
+
+   // Baked cache:
+   bool bake(const std::string &input, const std::string &output, bool optimize = false);
+   Eng::Node &loadBaked(const std::string &filename);
+
+
+/////////////
+protected: //
+/////////////
+
+   // Chunk writing:
+   static uint64_t beginChunk(Eng::Serializer &serial, ChunkId chunkId);
+   static bool endChunk(Eng::Serializer &serial, uint64_t start);
 };
 
@@ -156,5 +156,5 @@ bool ENG_API Eng::Pipeline::render(const glm::mat4 &camera, const glm::mat4 &pro
  */
 bool ENG_API Eng::Pipeline::render(const Eng::Camera &camera, const Eng::List &list)
 {	
-   return this->render(glm::inverse(camera.getWorldMatrix()), camera.getProjMatrix(), list);
+   return this->render(Eng::Math::inverse(camera.getWorldMatrix()), camera.getProjMatrix(), list);
 }
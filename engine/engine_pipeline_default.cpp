@@ -43,19 +43,114 @@ uniform mat3 normalMat;
 uniform mat4 lightMatrix;
 uniform mat4 worldMat;
 
+// Uniforms (compact vertex layout):
+uniform bool vertexCompact;
+uniform vec3 vertexScale;
+uniform vec3 vertexBias;
+
+// Per-instance data (instanced rendering):
+struct Instance
+{
+   mat4 modelviewMat;
+   mat4 worldMat;
+   mat4 normalMat;
+   uint frustumMask;
+};
+layout(std430, binding = 0) readonly buffer Instances
+{
+   Instance instances[];
+};
+uniform bool instanced;
+uniform uint firstInstance;
+
+// Per-draw data (multi-draw rendering):
+struct Draw
+{
+   mat4 modelviewMat;
+   mat4 worldMat;
+   mat4 normalMat;
+   vec4 vertexScale;
+   vec4 vertexBias;
+   uint material;
+   uint frustumMask;
+};
+layout(std430, binding = 1) readonly buffer Draws
+{
+   Draw draws[];
+};
+uniform bool multiDraw;
+uniform uint firstDraw;
+
 // Varying:
 out vec4 fragPosition;
 out vec3 normal;
+out vec4 tangent;
 out vec2 uv;
 out vec3 _fragPos;
+flat out uint materialId;
+
+/**
+ * Decodes an octahedral-encoded unit vector.
+ * @param e encoded vector
+ * @return unit vector
+ */
+vec3 octDecode(vec2 e)
+{
+   vec3 v = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+   if (v.z < 0.0f)
+      v.xy = (1.0f - abs(v.yx)) * vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+   return normalize(v);
+}
+
+/**
+ * Decodes a compact tangent: octahedral, with the handedness as the sign of the second component (remapped to 
+ * [1, 127] / 127).
+ * @param e encoded tangent
+ * @return tangent, handedness in w
+ */
+vec4 tangentDecode(vec2 e)
+{
+   return vec4(octDecode(vec2(e.x, (abs(e.y) * 127.0f - 1.0f) / 63.0f - 1.0f)), e.y < 0.0f ? -1.0f : 1.0f);
+}
 
 void main()
 {
-   normal = normalMat * a_normal.xyz;
+   // Per-instance or per-draw matrices:
+   mat4 _modelviewMat = modelviewMat;
+   mat4 _worldMat = worldMat;
+   mat3 _normalMat = normalMat;
+   vec3 _vertexScale = vertexScale;
+   vec3 _vertexBias = vertexBias;
+   materialId = 0;
+   if (instanced)
+   {
+      Instance instance = instances[firstInstance + gl_InstanceID];
+      _modelviewMat = instance.modelviewMat;
+      _worldMat = instance.worldMat;
+      _normalMat = mat3(instance.normalMat);
+   }
+   else if (multiDraw)
+   {
+      Draw draw = draws[firstDraw + gl_DrawID];
+      _modelviewMat = draw.modelviewMat;
+      _worldMat = draw.worldMat;
+      _normalMat = mat3(draw.normalMat);
+      _vertexScale = draw.vertexScale.xyz;
+      _vertexBias = draw.vertexBias.xyz;
+      materialId = draw.material;
+   }
+
+   // Dequantize (compact layout):
+   vec3 vertex = vertexCompact ? _vertexBias + a_vertex * _vertexScale : a_vertex;
+   vec3 n = vertexCompact ? octDecode(a_normal.xy) : a_normal.xyz;
+   vec4 t = vertexCompact ? tangentDecode(a_tangent.xy) : a_tangent;
+
+   normal = _normalMat * n;
+   tangent = vec4(mat3(_modelviewMat) * t.xyz, t.w);
    uv = a_uv;
 
-   fragPosition = modelviewMat * vec4(a_vertex, 1.0f);
-   _fragPos = (worldMat * vec4(a_vertex, 1.0f)).xyz;
+   fragPosition = _modelviewMat * vec4(vertex, 1.0f);
+   _fragPos = (_worldMat * vec4(vertex, 1.0f)).xyz;
    gl_Position = projectionMat * fragPosition;
 })";
 
@@ -90,6 +185,20 @@ uniform float mtlMetalness;
 uniform float bias;
 uniform float pfc_radius_scale_factor;
 
+// Per-material data (multi-draw rendering):
+struct Material
+{
+   vec4 emission;
+   vec4 albedo;
+   vec4 params; // Roughness, metalness, opacity
+   uvec2 textures[4];
+};
+layout(std430, binding = 2) readonly buffer Materials
+{
+   Material materials[];
+};
+uniform bool multiDraw;
+
 // Uniform (light):
 uniform uint totNrOfLights;
 uniform vec3 lightColor;
@@ -108,6 +217,7 @@ in vec4 fragPosition;
 in vec3 normal;
 in vec2 uv;
 in vec3 _fragPos;
+flat in uint materialId;
 
 // Output to the framebuffer:
 out vec4 outFragment;
@@ -160,15 +270,45 @@ float shadowAmount(vec3 fragPos)
  
 void main()
 {
+   // Material props (per-draw when multi-drawing):
+   vec3 _mtlEmission = mtlEmission;
+   vec3 _mtlAlbedo = mtlAlbedo;
+   float _mtlRoughness = mtlRoughness;
+   float _mtlMetalness = mtlMetalness;
+   float _mtlOpacity = mtlOpacity;
+   if (multiDraw)
+   {
+      _mtlEmission = materials[materialId].emission.rgb;
+      _mtlAlbedo = materials[materialId].albedo.rgb;
+      _mtlRoughness = materials[materialId].params.x;
+      _mtlMetalness = materials[materialId].params.y;
+      _mtlOpacity = materials[materialId].params.z;
+   }
+
    // Texture lookup:
-   vec4 albedo_texel = texture(texture0, uv);
-   vec4 normal_texel = texture(texture1, uv);
-   vec4 roughness_texel = mtlRoughness * texture(texture2, uv);
-   vec4 metalness_texel = mtlMetalness * texture(texture3, uv);
+   vec4 albedo_texel, normal_texel, roughness_texel, metalness_texel;
+#ifdef ENG_BINDLESS_SUPPORTED
+   if (multiDraw)
+   {
+      albedo_texel = texture(sampler2D(materials[materialId].textures[0]), uv);
+      normal_texel = texture(sampler2D(materials[materialId].textures[1]), uv);
+      roughness_texel = texture(sampler2D(materials[materialId].textures[2]), uv);
+      metalness_texel = texture(sampler2D(materials[materialId].textures[3]), uv);
+   }
+   else
+#endif
+   {
+      albedo_texel = texture(texture0, uv);
+      normal_texel = texture(texture1, uv);
+      roughness_texel = texture(texture2, uv);
+      metalness_texel = texture(texture3, uv);
+   }
+   roughness_texel *= _mtlRoughness;
+   metalness_texel *= _mtlMetalness;
    float justUseIt = albedo_texel.r + normal_texel.r + roughness_texel.r + metalness_texel.r;
 
    // Material props:
-   justUseIt += mtlEmission.r + mtlAlbedo.r + mtlOpacity + mtlRoughness + mtlMetalness;
+   justUseIt += _mtlEmission.r + _mtlAlbedo.r + _mtlOpacity + _mtlRoughness + _mtlMetalness;
 
    vec3 fragColor = lightAmbient; 
    
@@ -191,7 +331,7 @@ void main()
       fragColor += (1.0f - roughness_texel.r) * pow(nDotH, 70.0f) * lightColor * shadow;         
    }
    
-   outFragment = vec4((mtlEmission / float(totNrOfLights)) + fragColor * albedo_texel.xyz, justUseIt);
+   outFragment = vec4((_mtlEmission / float(totNrOfLights)) + fragColor * albedo_texel.xyz, justUseIt);
    if(depthBuffer == 1) {
       outFragment = vec4(vec3(closestDepth / far_plane), 1.0f); // Debugging shadow map
    }
@@ -496,6 +636,9 @@ bool ENG_API Eng::PipelineDefault::render(const glm::mat4& camera, const glm::ma
    if (isWireframe())
       glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);      
 
+   // Skip the meshes outside of the view frustum (shadow casters are not affected):
+   list.cull(proj * camera, Eng::List::Pass::meshes);
+
    // Multipass rendering:
    uint32_t totNrOfLights = list.getNrOfLights();
    program.setUInt("totNrOfLights", totNrOfLights);
@@ -511,17 +654,17 @@ bool ENG_API Eng::PipelineDefault::render(const glm::mat4& camera, const glm::ma
       
       // Render one light at time:
       const Eng::List::RenderableElem &lightRe = list.getRenderableElem(l);   
-      const Eng::Light &light = dynamic_cast<const Eng::Light &>(lightRe.reference.get());
+      const Eng::Light &light = lightRe.reference.get().as<Eng::Light>();
 
       // Render shadow map:
-      reserved->shadowMapping.render(glm::inverse(lightRe.matrix), light.getProjMatrix(), list);
+      reserved->shadowMapping.render(Eng::Math::inverse(lightRe.matrix), light.getProjMatrix(), list);
 
       // Re-enable this pipeline's program:
       program.render();   
       glm::mat4 lightFinalMatrix = camera * lightRe.matrix; // Light position in eye coords
       lightRe.reference.get().render(0, &lightFinalMatrix);
 
-      lightFinalMatrix = light.getProjMatrix() * glm::inverse(lightRe.matrix) * glm::inverse(camera); // To convert from eye coords into light space
+      lightFinalMatrix = light.getProjMatrix() * Eng::Math::inverse(lightRe.matrix) * Eng::Math::inverse(camera); // To convert from eye coords into light space
       program.setMat4("lightMatrix", lightFinalMatrix);
       Eng::Base& eng = Eng::Base::getInstance();
       program.setFloat("far_plane", eng.getFarPlane());
@@ -555,5 +698,5 @@ bool ENG_API Eng::PipelineDefault::render(const glm::mat4& camera, const glm::ma
  */
 bool ENG_API Eng::PipelineDefault::render(const Eng::Camera &camera, const Eng::List &list)
 {
-   return this->render(glm::inverse(camera.getWorldMatrix()), camera.getProjMatrix(), list);
+   return this->render(Eng::Math::inverse(camera.getWorldMatrix()), camera.getProjMatrix(), list);
 }
\ No newline at end of file
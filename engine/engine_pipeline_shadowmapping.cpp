@@ -39,17 +39,76 @@ layout(location = 3) in vec4 a_tangent;
 // Uniforms:
 uniform mat4 modelviewMat;
 uniform mat4 lightInv;
+uniform uint frustumMask;
+
+// Uniforms (compact vertex layout):
+uniform bool vertexCompact;
+uniform vec3 vertexScale;
+uniform vec3 vertexBias;
+
+// Per-instance data (instanced rendering):
+struct Instance
+{
+   mat4 modelviewMat;
+   mat4 worldMat;
+   mat4 normalMat;
+   uint frustumMask;
+};
+layout(std430, binding = 0) readonly buffer Instances
+{
+   Instance instances[];
+};
+uniform bool instanced;
+uniform uint firstInstance;
+
+// Per-draw data (multi-draw rendering):
+struct Draw
+{
+   mat4 modelviewMat;
+   mat4 worldMat;
+   mat4 normalMat;
+   vec4 vertexScale;
+   vec4 vertexBias;
+   uint material;
+   uint frustumMask;
+};
+layout(std430, binding = 1) readonly buffer Draws
+{
+   Draw draws[];
+};
+uniform bool multiDraw;
+uniform uint firstDraw;
+
+// Cube faces touched by the mesh (to the geometry shader):
+out uint faceMask;
 
 void main()
 {   
-   gl_Position = lightInv * modelviewMat * vec4(a_vertex, 1.0f);
+   mat4 _modelviewMat = modelviewMat;
+   vec3 _vertexScale = vertexScale;
+   vec3 _vertexBias = vertexBias;
+   faceMask = frustumMask;
+   if (instanced)
+   {
+      _modelviewMat = instances[firstInstance + gl_InstanceID].modelviewMat;
+      faceMask = instances[firstInstance + gl_InstanceID].frustumMask;
+   }
+   else if (multiDraw)
+   {
+      _modelviewMat = draws[firstDraw + gl_DrawID].modelviewMat;
+      _vertexScale = draws[firstDraw + gl_DrawID].vertexScale.xyz;
+      _vertexBias = draws[firstDraw + gl_DrawID].vertexBias.xyz;
+      faceMask = draws[firstDraw + gl_DrawID].frustumMask;
+   }
+   vec3 vertex = vertexCompact ? _vertexBias + a_vertex * _vertexScale : a_vertex;
+   gl_Position = lightInv * _modelviewMat * vec4(vertex, 1.0f);
 }
 )";
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Geometry shader that connects the vertex to the fragment shader.
- * It transforms the vertex from world space to 6 different light spaces.
+ * It transforms the vertex from world space to the light spaces of the cube faces touched by the mesh.
  */
 static const std::string pipeline_gs = R"(
 
@@ -58,6 +117,9 @@ layout (triangle_strip, max_vertices=18) out;
 
 uniform mat4 shadowMatrices[6];
 
+// Cube faces touched by the mesh (from the vertex shader):
+in uint faceMask[];
+
 // FragPos from GS (output per emitvertex)
 out vec4 FragPos;
 
@@ -66,6 +128,10 @@ void main()
 {
     for(int face = 0; face < 6; ++face)
     {
+        // skip the faces the mesh cannot touch
+        if ((faceMask[0] & (1u << face)) == 0u)
+            continue;
+
         // built-in variable that specifies to which face we render.
         gl_Layer = face;
 
@@ -340,6 +406,14 @@ bool ENG_API Eng::PipelineShadowMapping::render(const glm::mat4& camera, const g
         program.setMat4("shadowMatrices[" + std::to_string(i) + "]", shadowTransforms[i]);
     }
     program.setFloat("far_plane", farPlane);
+    program.setUInt("frustumMask", 0x3F);
+
+    // Cull the casters against each face, within the light range (far plane of the projection). Faces are tested with
+    // the same transform as the shaders (lightInv * modelviewMat, then the face matrix):
+    std::vector<glm::mat4> faceFrusta;
+    for (unsigned int i = 0; i < 6; ++i)
+        faceFrusta.push_back(shadowTransforms[i] * camera * camera);
+    list.cull(faceFrusta, Eng::List::Pass::casters);
 
     // Bind FBO and change OpenGL settings:
     reserved->fbo.render();
@@ -351,8 +425,8 @@ bool ENG_API Eng::PipelineShadowMapping::render(const glm::mat4& camera, const g
 	
     }
 
-    // Render meshes:   
-    list.render(camera, proj, Eng::List::Pass::meshes);
+    // Render meshes (as shadow casters, each on the faces it touches only):   
+    list.render(camera, proj, Eng::List::Pass::casters);
 
     // Redo OpenGL settings:
     if (reserved->frontFaceCulling) {
@@ -377,5 +451,5 @@ bool ENG_API Eng::PipelineShadowMapping::render(const glm::mat4& camera, const g
  */
 bool ENG_API Eng::PipelineShadowMapping::render(const Eng::Camera& camera, const Eng::List& list)
 {
-    return this->render(glm::inverse(camera.getWorldMatrix()), camera.getProjMatrix(), list);
+    return this->render(Eng::Math::inverse(camera.getWorldMatrix()), camera.getProjMatrix(), list);
 }
\ No newline at end of file
@@ -229,7 +229,7 @@ bool ENG_API Eng::PipelineSkybox::render(const Eng::Texture& texture, const Eng:
     texture.render(0);
 
     program.setMat4("projection", camera.getProjMatrix());
-    program.setMat4("modelview", glm::inverse(camera.getWorldMatrix()));
+    program.setMat4("modelview", Eng::Math::inverse(camera.getWorldMatrix()));
 
     renderCube();
 
@@ -0,0 +1,207 @@
+/**
+ * @file		engine_pool.cpp
+ * @brief	Chunked, address-stable object storage
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // C/C++:
+   #include <atomic>
+   #include <mutex>
+   #include <new>
+
+
+
+////////////
+// STATIC //
+////////////
+
+   // Statistics (pools are shared by the loading threads):
+   static std::atomic<uint64_t> nrOfChunks = 0;
+   static std::atomic<uint64_t> nrOfAllocations = 0;
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief Pool reserved structure.
+ */
+struct Eng::Pool::Reserved
+{
+   uint64_t blockSize;              ///< Size of a block, in bytes (multiple of the alignment)
+   uint64_t blockAlignment;         ///< Alignment of a block, in bytes
+   std::vector<void *> chunks;      ///< Chunks allocated so far
+   void *freeList;                  ///< First free block (each free block stores a pointer to the next one)
+   std::mutex mutex;                ///< Serializes the accesses
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : blockSize{ 0 }, blockAlignment{ 0 }, freeList{ nullptr }
+   {}
+};
+
+
+
+////////////////////////
+// BODY OF CLASS Pool //
+////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ * @param blockSize size of a block, in bytes
+ * @param blockAlignment alignment of a block, in bytes
+ */
+ENG_API Eng::Pool::Pool(uint64_t blockSize, uint64_t blockAlignment) : reserved(std::make_unique<Eng::Pool::Reserved>())
+{
+   ENG_LOG_DETAIL("[+]");
+
+   // Free blocks must be able to hold a pointer:
+   blockAlignment = std::max(blockAlignment, static_cast<uint64_t>(alignof(void *)));
+   reserved->blockAlignment = blockAlignment;
+   reserved->blockSize = ((std::max(blockSize, static_cast<uint64_t>(sizeof(void *))) + blockAlignment - 1) / blockAlignment) * blockAlignment;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor. Releases the chunks (blocks still in use become invalid).
+ */
+ENG_API Eng::Pool::~Pool()
+{
+   ENG_LOG_DETAIL("[-]");
+   for (auto &c : reserved->chunks)
+      releaseChunk(c, reserved->blockAlignment);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Allocates a block. A new chunk is taken from the heap only when the free list is empty.
+ * @return pointer to the block
+ */
+void ENG_API *Eng::Pool::allocate()
+{
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+
+   // Refill the free list:
+   if (reserved->freeList == nullptr)
+   {
+      const uint64_t nrOfBlocks = std::max(defaultChunkSize / reserved->blockSize, static_cast<uint64_t>(1));
+      uint8_t *chunk = static_cast<uint8_t *>(allocateChunk(nrOfBlocks * reserved->blockSize, reserved->blockAlignment));
+      reserved->chunks.push_back(chunk);
+      for (uint64_t c = nrOfBlocks; c > 0; c--)
+      {
+         void *block = chunk + (c - 1) * reserved->blockSize;
+         *static_cast<void **>(block) = reserved->freeList;
+         reserved->freeList = block;
+      }
+   }
+
+   // Pop:
+   void *block = reserved->freeList;
+   reserved->freeList = *static_cast<void **>(block);
+   countAllocation();
+
+   // Done:
+   return block;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases a block back to the pool.
+ * @param block pointer to the block, as returned by allocate()
+ */
+void ENG_API Eng::Pool::release(void *block)
+{
+   // Safety net:
+   if (block == nullptr)
+      return;
+
+   std::lock_guard<std::mutex> lock(reserved->mutex);
+   *static_cast<void **>(block) = reserved->freeList;
+   reserved->freeList = block;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Allocates a chunk of memory from the heap.
+ * @param size size in bytes
+ * @param alignment alignment in bytes
+ * @return pointer to the chunk
+ */
+void ENG_API *Eng::Pool::allocateChunk(uint64_t size, uint64_t alignment)
+{
+   nrOfChunks++;
+   return ::operator new(size, std::align_val_t(alignment));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases a chunk allocated with allocateChunk().
+ * @param chunk pointer to the chunk
+ * @param alignment alignment in bytes, as passed to allocateChunk()
+ */
+void ENG_API Eng::Pool::releaseChunk(void *chunk, uint64_t alignment)
+{
+   ::operator delete(chunk, std::align_val_t(alignment));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of chunks taken from the heap so far, by all the pools and colonies.
+ * @return number of heap allocations
+ */
+uint64_t ENG_API Eng::Pool::getNrOfChunks()
+{
+   return nrOfChunks;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the number of objects allocated so far from all the pools and colonies.
+ * @return number of allocations
+ */
+uint64_t ENG_API Eng::Pool::getNrOfAllocations()
+{
+   return nrOfAllocations;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Counts one object allocation.
+ */
+void ENG_API Eng::Pool::countAllocation()
+{
+   nrOfAllocations++;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Prints the allocation statistics.
+ */
+void ENG_API Eng::Pool::dumpReport()
+{
+   ENG_LOG_PLAIN("%llu pooled allocation(s), %llu heap allocation(s)", getNrOfAllocations(), getNrOfChunks());
+}
@@ -0,0 +1,463 @@
+/**
+ * @file		engine_pool.h
+ * @brief	Chunked, address-stable object storage
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+#pragma once
+
+
+
+/**
+ * @brief Fixed-size block allocator. Blocks are carved out of large chunks that are never returned to the heap, and
+ *        released blocks are recycled through a free list, so that allocating an object costs no heap allocation once
+ *        the pool is warm. Pools are thread-safe. The static methods give access to the raw chunks (also used by
+ *        Colony) and to the allocation statistics of all the pools.
+ */
+class ENG_API Pool final
+{
+//////////
+public: //
+//////////
+
+   // Consts:
+   static constexpr uint64_t defaultChunkSize = 64 * 1024;    ///< Size of a pool chunk, in bytes
+
+   // Const/dest:
+   Pool(uint64_t blockSize, uint64_t blockAlignment);
+   Pool(Pool const &) = delete;
+   ~Pool();
+
+   // Operators:
+   void operator=(Pool const &) = delete;
+
+   // Shared pools:
+   template <uint64_t blockSize, uint64_t blockAlignment> static Pool &getInstance();
+
+   // Blocks:
+   void *allocate();
+   void release(void *block);
+
+   // Chunks:
+   static void *allocateChunk(uint64_t size, uint64_t alignment);
+   static void releaseChunk(void *chunk, uint64_t alignment);
+
+   // Statistics:
+   static uint64_t getNrOfChunks();
+   static uint64_t getNrOfAllocations();
+   static void dumpReport();
+
+
+///////////
+private: //
+///////////
+
+   // Statistics:
+   static void countAllocation();
+
+   // Reserved:
+   struct Reserved;
+   std::unique_ptr<Reserved> reserved;
+
+   template <typename T> friend class Colony;
+};
+
+
+
+/**
+ * @brief Base for the classes whose instances are allocated from a shared pool (typically the reserved structures
+ *        of the engine objects, allocated once per object). Usage: struct X : Eng::Pooled<X> { ... };
+ */
+template <typename T>
+class Pooled
+{
+//////////
+public: //
+//////////
+
+   // Operators:
+   static void *operator new(std::size_t size);
+   static void operator delete(void *ptr, std::size_t size);
+};
+
+
+
+/**
+ * @brief STL allocator taking single elements (e.g., the nodes of a std::list or of a std::unordered_map) from the 
+ *        shared pool of their size. Arrays are allocated from the heap.
+ */
+template <typename T>
+class PoolAllocator
+{
+//////////
+public: //
+//////////
+
+   // Traits:
+   using value_type = T;
+
+   // Const/dest:
+   PoolAllocator() = default;
+   template <typename U> PoolAllocator(const PoolAllocator<U> &) {}
+
+   // Operators:
+   template <typename U> bool operator==(const PoolAllocator<U> &) const { return true; }
+   template <typename U> bool operator!=(const PoolAllocator<U> &) const { return false; }
+
+   // Management:
+   T *allocate(std::size_t n);
+   void deallocate(T *ptr, std::size_t n);
+};
+
+
+
+/**
+ * @brief Address-stable container (in the spirit of a colony). Elements are stored in fixed-size chunks that are never
+ *        moved, so references stay valid while the container grows (as with std::list), but elements are contiguous 
+ *        within each chunk and inserting costs no heap allocation but once every Colony::chunkSize elements. Each 
+ *        slot has a generation counter (odd while the slot holds an element), so that a slot and a generation can be
+ *        used as a handle that never resolves to a newer element taking the slot after an erase.
+ */
+template <typename T>
+class Colony final
+{
+//////////
+public: //
+//////////
+
+   // Consts:
+   static constexpr uint64_t chunkSize = 64;    ///< Nr. of elements per chunk
+   static constexpr uint64_t none = ~0ull;      ///< Invalid slot
+
+
+   /**
+    * @brief Forward iterator, walking the slots in order and skipping the erased ones.
+    */
+   template <typename V>
+   class Iterator final
+   {
+   //////////
+   public: //
+   //////////
+
+      // Traits:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = V *;
+      using reference = V &;
+
+      // Const/dest:
+      Iterator(const Colony &colony, uint64_t slot);
+
+      // Operators:
+      V &operator*() const { return *current; }
+      V *operator->() const { return current; }
+      Iterator &operator++();
+      bool operator==(const Iterator &rhs) const { return slot == rhs.slot; }
+      bool operator!=(const Iterator &rhs) const { return slot != rhs.slot; }
+
+
+   ///////////
+   private: //
+   ///////////
+
+      // Management:
+      void skip();
+
+      const Colony *colony;   ///< Container
+      uint64_t slot;          ///< Current slot
+      V *current;             ///< Current element (nullptr at the end)
+   };
+
+   using iterator = Iterator<T>;
+   using const_iterator = Iterator<const T>;
+
+
+   // Const/dest:
+   Colony() : nrOfElements{ 0 }, lastSlot{ none } {}
+   Colony(Colony const &) = delete;
+   ~Colony();
+
+   // Operators:
+   void operator=(Colony const &) = delete;
+
+   // Get/set:
+   bool empty() const { return nrOfElements == 0; }
+   uint64_t size() const { return nrOfElements; }
+   T *getLast() const { return (lastSlot == none) ? nullptr : at(lastSlot); }
+   uint64_t getLastSlot() const { return lastSlot; }
+   uint32_t getGeneration(uint64_t slot) const { return (slot < generations.size()) ? generations[slot] : 0; }
+   T *get(uint64_t slot, uint32_t generation) const;
+
+   // Management:
+   template <typename... Args> T &emplace(Args &&... args);
+   bool erase(uint64_t slot);
+   void clear();
+
+   // Iterators:
+   iterator begin() { return iterator(*this, 0); }
+   iterator end() { return iterator(*this, generations.size()); }
+   const_iterator begin() const { return const_iterator(*this, 0); }
+   const_iterator end() const { return const_iterator(*this, generations.size()); }
+
+
+///////////
+private: //
+///////////
+
+   // Get/set:
+   T *at(uint64_t slot) const { return chunks[slot / chunkSize] + slot % chunkSize; }
+
+   std::vector<T *> chunks;               ///< Chunks, each one with room for chunkSize elements (nullptr once released)
+   std::vector<uint32_t> generations;     ///< Per slot generation (odd while the slot holds an element)
+   std::vector<uint64_t> freeSlots;       ///< Erased slots, reused first
+   uint64_t nrOfElements;                 ///< Nr. of elements
+   uint64_t lastSlot;                     ///< Slot of the last inserted element, if still there
+};
+
+
+//////////////////////
+// TEMPLATE METHODS //
+//////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the pool shared by all the objects with the given block size and alignment. Pools are never destroyed, as 
+ * their blocks can still be released by the destructors of static objects.
+ * @return pool reference
+ */
+template <uint64_t blockSize, uint64_t blockAlignment>
+Pool &Pool::getInstance()
+{
+   static Pool *pool = new Pool(blockSize, blockAlignment);
+   return *pool;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Allocates an instance from the pool of the class.
+ * @param size size of the instance
+ * @return pointer to the allocated block
+ */
+template <typename T>
+void *Pooled<T>::operator new(std::size_t size)
+{
+   // Derived classes are not pooled:
+   if (size != sizeof(T))
+      return ::operator new(size);
+   return Pool::getInstance<sizeof(T), alignof(T)>().allocate();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases an instance to the pool of the class.
+ * @param ptr pointer to the block
+ * @param size size of the instance
+ */
+template <typename T>
+void Pooled<T>::operator delete(void *ptr, std::size_t size)
+{
+   if (ptr == nullptr)
+      return;
+   if (size != sizeof(T))
+      ::operator delete(ptr);
+   else
+      Pool::getInstance<sizeof(T), alignof(T)>().release(ptr);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Allocates storage for n elements.
+ * @param n number of elements
+ * @return pointer to the storage
+ */
+template <typename T>
+T *PoolAllocator<T>::allocate(std::size_t n)
+{
+   if (n != 1)
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+   return static_cast<T *>(Pool::getInstance<sizeof(T), alignof(T)>().allocate());
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases storage allocated with allocate().
+ * @param ptr pointer to the storage
+ * @param n number of elements
+ */
+template <typename T>
+void PoolAllocator<T>::deallocate(T *ptr, std::size_t n)
+{
+   if (n != 1)
+      ::operator delete(ptr);
+   else
+      Pool::getInstance<sizeof(T), alignof(T)>().release(ptr);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ * @param colony container to iterate
+ * @param slot first slot to visit (erased slots are skipped)
+ */
+template <typename T>
+template <typename V>
+Colony<T>::Iterator<V>::Iterator(const Colony &colony, uint64_t slot) : colony{ &colony }, slot{ slot }, current{ nullptr }
+{
+   skip();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Moves to the next element.
+ * @return iterator reference
+ */
+template <typename T>
+template <typename V>
+typename Colony<T>::template Iterator<V> &Colony<T>::Iterator<V>::operator++()
+{
+   slot++;
+   skip();
+   return *this;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Moves forward to the first slot holding an element (or to the end).
+ */
+template <typename T>
+template <typename V>
+void Colony<T>::Iterator<V>::skip()
+{
+   const uint64_t nrOfSlots = colony->generations.size();
+   while (slot < nrOfSlots && (colony->generations[slot] & 1) == 0)
+      slot++;
+   current = (slot < nrOfSlots) ? colony->at(slot) : nullptr;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+template <typename T>
+Colony<T>::~Colony()
+{
+   clear();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Gets the element in a slot, if the slot still holds the element of the given generation.
+ * @param slot slot
+ * @param generation generation of the slot when the element was inserted
+ * @return element or nullptr if erased (or invalid)
+ */
+template <typename T>
+T *Colony<T>::get(uint64_t slot, uint32_t generation) const
+{
+   if (slot >= generations.size() || generations[slot] != generation || (generation & 1) == 0)
+      return nullptr;
+   return at(slot);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructs a new element, in the last erased slot or else at the end. References to the other elements stay valid.
+ * Use getLastSlot() to get its slot.
+ * @param args arguments passed to the constructor of T
+ * @return new element
+ */
+template <typename T>
+template <typename... Args>
+T &Colony<T>::emplace(Args &&... args)
+{
+   // Pick a slot:
+   uint64_t slot;
+   if (!freeSlots.empty())
+   {
+      slot = freeSlots.back();
+      freeSlots.pop_back();
+   }
+   else
+   {
+      slot = generations.size();
+      generations.push_back(0);
+      if (slot == chunks.size() * chunkSize)
+         chunks.push_back(nullptr);
+   }
+
+   // Chunk released by clear()?
+   T *&chunk = chunks[slot / chunkSize];
+   if (chunk == nullptr)
+      chunk = static_cast<T *>(Pool::allocateChunk(chunkSize * sizeof(T), alignof(T)));
+
+   T *element = new (chunk + slot % chunkSize) T(std::forward<Args>(args)...);
+   generations[slot]++;
+   nrOfElements++;
+   lastSlot = slot;
+   Pool::countAllocation();
+   return *element;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destroys the element in a slot. The slot is reused by the next insertions, with a new generation.
+ * @param slot slot
+ * @return TF
+ */
+template <typename T>
+bool Colony<T>::erase(uint64_t slot)
+{
+   // Safety net:
+   if (slot >= generations.size() || (generations[slot] & 1) == 0)
+      return false;
+
+   at(slot)->~T();
+   generations[slot]++;
+   freeSlots.push_back(slot);
+   nrOfElements--;
+   if (slot == lastSlot)
+      lastSlot = none;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destroys all the elements (in slot order) and releases the chunks. Generations are kept, so that older slots and 
+ * generations never resolve to the elements inserted afterwards.
+ */
+template <typename T>
+void Colony<T>::clear()
+{
+   for (auto &c : *this)
+      c.~T();
+   for (auto &c : chunks)
+   {
+      if (c)
+         Pool::releaseChunk(c, alignof(T));
+      c = nullptr;
+   }
+
+   // All the slots are free (lowest first):
+   freeSlots.clear();
+   for (uint64_t c = generations.size(); c > 0; c--)
+   {
+      generations[c - 1] += generations[c - 1] & 1;
+      freeSlots.push_back(c - 1);
+   }
+   nrOfElements = 0;
+   lastSlot = none;
+}
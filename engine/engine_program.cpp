@@ -70,6 +70,7 @@ struct Eng::Program::Reserved
 ENG_API Eng::Program::Program() : reserved(std::make_unique<Eng::Program::Reserved>())
 {
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -81,6 +82,7 @@ ENG_API Eng::Program::Program() : reserved(std::make_unique<Eng::Program::Reserv
 ENG_API Eng::Program::Program(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Program::Reserved>())
 {
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -91,6 +93,7 @@ ENG_API Eng::Program::Program(const std::string &name) : Eng::Object(name), rese
 ENG_API Eng::Program::Program(Program &&other) : Eng::Object(std::move(other)), Eng::Managed(std::move(other)), reserved(std::move(other.reserved))
 {
    ENG_LOG_DETAIL("[M]");
+   typeTags = tags;
 }
 
 
@@ -246,7 +249,7 @@ bool ENG_API Eng::Program::build(std::initializer_list<std::reference_wrapper<En
    // Link shaders:
    for (uint32_t c = 0; c < this->getNrOfShaders(); c++)
    {
-      const Eng::Shader &s = dynamic_cast<const Eng::Shader &>(this->getShader(c));
+      const Eng::Shader &s = this->getShader(c);
       glAttachShader(reserved->oglId, s.getOglHandle());
    }
    glLinkProgram(reserved->oglId);
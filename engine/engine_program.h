@@ -20,6 +20,9 @@ public: //
    // Special values:
    static Program empty;
 
+   // Type tags:
+   static constexpr uint32_t tags = Eng::Object::tags | static_cast<uint32_t>(Tag::program);
+
 
    /**
     * @brief Types of program.
@@ -15,7 +15,19 @@
    #include "engine.h"
 
    // C/C++:
-   #include <iterator>
+   #include <fstream>
+
+   // OS:
+#ifdef _WINDOWS
+   #define WIN32_LEAN_AND_MEAN
+   #define NOMINMAX
+   #include <windows.h>
+#else
+   #include <fcntl.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+#endif
 
 
 
@@ -32,6 +44,92 @@
 // RESERVED STRUCTURES //
 /////////////////////////
 
+/**
+ * @brief Read-only view of a file mapped into memory. Shared among the serializers copying it.
+ */
+struct FileMapping
+{
+   uint8_t *ptr;                 ///< First byte of the mapping
+   uint64_t nrOfBytes;           ///< Size of the mapping
+#ifdef _WINDOWS
+   HANDLE file;                  ///< File handle
+   HANDLE mapping;               ///< File mapping handle
+#endif
+
+
+   /**
+    * Constructor.
+    */
+#ifdef _WINDOWS
+   FileMapping() : ptr{ nullptr }, nrOfBytes{ 0 }, file{ INVALID_HANDLE_VALUE }, mapping{ nullptr }
+#else
+   FileMapping() : ptr{ nullptr }, nrOfBytes{ 0 }
+#endif
+   {}
+
+   /**
+    * Destructor.
+    */
+   ~FileMapping()
+   {
+#ifdef _WINDOWS
+      if (ptr)
+         UnmapViewOfFile(ptr);
+      if (mapping)
+         CloseHandle(mapping);
+      if (file != INVALID_HANDLE_VALUE)
+         CloseHandle(file);
+#else
+      if (ptr)
+         munmap(ptr, nrOfBytes);
+#endif
+   }
+
+   /**
+    * Maps the given file. Pages are copy-on-write, so the file is never modified.
+    * @param filename file to map
+    * @return TF
+    */
+   bool open(const std::string &filename)
+   {
+#ifdef _WINDOWS
+      file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+      if (file == INVALID_HANDLE_VALUE)
+         return false;
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+         return false;
+      mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+      if (mapping == nullptr)
+         return false;
+      ptr = static_cast<uint8_t *>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+      if (ptr == nullptr)
+         return false;
+      nrOfBytes = static_cast<uint64_t>(size.QuadPart);
+#else
+      int fd = ::open(filename.c_str(), O_RDONLY);
+      if (fd < 0)
+         return false;
+      struct stat info;
+      if (fstat(fd, &info) != 0 || info.st_size == 0)
+      {
+         close(fd);
+         return false;
+      }
+      void *addr = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      close(fd); // The mapping keeps its own reference to the file
+      if (addr == MAP_FAILED)
+         return false;
+      ptr = static_cast<uint8_t *>(addr);
+      nrOfBytes = static_cast<uint64_t>(info.st_size);
+#endif
+
+      // Done:
+      return true;
+   }
+};
+
+
 /**
  * @brief Serializer reserved structure.
  */
@@ -39,7 +137,8 @@ struct Eng::Serializer::Reserved
 {
    uint64_t position;
    uint64_t nrOfBytes;
-   std::vector<uint8_t> data;
+   std::vector<uint8_t> data;                ///< Owned data (unused when viewing a mapping)
+   std::shared_ptr<FileMapping> mapping;     ///< Optional memory-mapped file this serializer is a view of
 
 
    /**
@@ -47,6 +146,15 @@ struct Eng::Serializer::Reserved
     */
    Reserved() : position{ 0 }, nrOfBytes{ 0 }
    {}
+
+   /**
+    * Gets the first byte of the serialized data, either owned or mapped.
+    * @return pointer to the first byte
+    */
+   inline uint8_t *base() const
+   {
+      return mapping ? mapping->ptr : const_cast<uint8_t *>(data.data());
+   }
 };
 
 
@@ -91,7 +199,7 @@ ENG_API Eng::Serializer::Serializer(const void *rawData, uint64_t nrOfBytes) : r
    else
    {
       const uint8_t *ptr = static_cast<const uint8_t *>(rawData);
-      std::copy(ptr, ptr + nrOfBytes, std::back_inserter(reserved->data));
+      reserved->data.assign(ptr, ptr + nrOfBytes);
    }
 }
 
@@ -123,8 +231,7 @@ void ENG_API Eng::Serializer::operator=(const Serializer &other)
  */
 void ENG_API *Eng::Serializer::getData() const
 {
-   reserved->data.shrink_to_fit();
-   return static_cast<void *>(reserved->data.data());   
+   return static_cast<void *>(reserved->base());   
 }
 
 
@@ -138,8 +245,7 @@ void ENG_API *Eng::Serializer::getDataAtCurPos() const
    if (reserved->position >= reserved->nrOfBytes)
       return nullptr;
 
-   reserved->data.shrink_to_fit();
-   return static_cast<void *>(reserved->data.data() + reserved->position);
+   return static_cast<void *>(reserved->base() + reserved->position);
 }
 
 
@@ -154,6 +260,111 @@ uint64_t ENG_API Eng::Serializer::getNrOfBytes() const
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns the current deserializing position.
+ * @return position in bytes from the beginning of the data
+ */
+uint64_t ENG_API Eng::Serializer::getPosition() const
+{
+   return reserved->position;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Moves the current deserializing position.
+ * @param position position in bytes from the beginning of the data
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::setPosition(uint64_t position)
+{
+   // Safety net:
+   if (position > reserved->nrOfBytes)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Done:
+   reserved->position = position;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Returns true when the serializer is a view of a memory-mapped file.
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::isMapped() const
+{
+   return reserved->mapping != nullptr;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Turns the serializer into a non-owning view of the given file, mapped into memory. Data is paged in on access 
+ * instead of being read and copied upfront. Previous content is released.
+ * @param filename file to map
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::map(const std::string &filename)
+{
+   // Safety net:
+   if (filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Map file:
+   std::shared_ptr<FileMapping> mapping = std::make_shared<FileMapping>();
+   if (!mapping->open(filename))
+   {
+      ENG_LOG_ERROR("Unable to map file '%s'", filename.c_str());
+      return false;
+   }
+
+   // Replace content:
+   this->clear();
+   reserved->mapping = mapping;
+   reserved->nrOfBytes = mapping->nrOfBytes;
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Writes the serialized data to a file.
+ * @param filename destination file
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::save(const std::string &filename) const
+{
+   // Safety net:
+   if (filename.empty())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   std::ofstream file(filename, std::ios::binary);
+   file.write(reinterpret_cast<const char *>(reserved->base()), reserved->nrOfBytes);
+   if (!file)
+   {
+      ENG_LOG_ERROR("Unable to write file '%s'", filename.c_str());
+      return false;
+   }
+
+   // Done:
+   return true;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Resets the internal data. 
@@ -171,11 +382,33 @@ void ENG_API Eng::Serializer::reset()
 void ENG_API Eng::Serializer::clear()
 {
    reserved->data.clear();
+   reserved->mapping.reset();
    reserved->position = 0;
    reserved->nrOfBytes = 0;
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Moves the current position forward without reading the data.
+ * @param nrOfBytes number of bytes to skip
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::skip(uint64_t nrOfBytes)
+{
+   // Safety net:
+   if (reserved->position + nrOfBytes > reserved->nrOfBytes)
+   {
+      ENG_LOG_ERROR("Buffer overflow");
+      return false;
+   }
+
+   // Done:
+   reserved->position += nrOfBytes;
+   return true;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Deserializes a string.
@@ -184,15 +417,18 @@ void ENG_API Eng::Serializer::clear()
  */
 bool ENG_API Eng::Serializer::deserialize(std::string &text)
 { 
-   uint32_t size = (uint32_t) strlen((char *)(&reserved->data[reserved->position]));   
-   if (reserved->position + size > reserved->nrOfBytes)
+   // Look for the terminator within the remaining data only:
+   const char *begin = reinterpret_cast<const char *>(reserved->base() + reserved->position);
+   const char *end = reserved->position < reserved->nrOfBytes ? 
+                     static_cast<const char *>(memchr(begin, '\0', reserved->nrOfBytes - reserved->position)) : nullptr;
+   if (end == nullptr)
    {
       ENG_LOG_ERROR("Corrupted serialization");
       return false;
    }
-   text.resize(size);
-   deserialize(text.data(), size);
-   reserved->position++;
+
+   text.assign(begin, end);
+   reserved->position += (end - begin) + 1;
 
    // Done:
    return true;
@@ -207,10 +443,7 @@ bool ENG_API Eng::Serializer::deserialize(std::string &text)
  */
 bool ENG_API Eng::Serializer::deserialize(uint8_t &byte)
 {
-   deserialize(&byte, sizeof(uint8_t));
-
-   // Done:
-   return true;
+   return read(byte);
 }
 
 
@@ -222,10 +455,7 @@ bool ENG_API Eng::Serializer::deserialize(uint8_t &byte)
  */
 bool ENG_API Eng::Serializer::deserialize(bool &_bool)
 {
-   deserialize(&_bool, sizeof(bool));
-
-   // Done:
-   return true;
+   return read(_bool);
 }
 
 
@@ -237,10 +467,7 @@ bool ENG_API Eng::Serializer::deserialize(bool &_bool)
  */
 bool ENG_API Eng::Serializer::deserialize(uint32_t &uint)
 {
-   deserialize(&uint, sizeof(uint32_t));
-
-   // Done:
-   return true;
+   return read(uint);
 }
 
 
@@ -252,10 +479,7 @@ bool ENG_API Eng::Serializer::deserialize(uint32_t &uint)
  */
 bool ENG_API Eng::Serializer::deserialize(float &_float)
 {
-   deserialize(&_float, sizeof(float));
-
-   // Done:
-   return true;
+   return read(_float);
 }
 
 
@@ -266,11 +490,8 @@ bool ENG_API Eng::Serializer::deserialize(float &_float)
  * @return TF
  */
 bool ENG_API Eng::Serializer::deserialize(glm::vec3 &vec)
-{   
-   deserialize(&vec, sizeof(glm::vec3));   
-
-   // Done:
-   return true;
+{
+   return read(vec);
 }
 
 
@@ -282,10 +503,7 @@ bool ENG_API Eng::Serializer::deserialize(glm::vec3 &vec)
  */
 bool ENG_API Eng::Serializer::deserialize(glm::vec4 &vec)
 {
-   deserialize(&vec, sizeof(glm::vec4));
-
-   // Done:
-   return true;
+   return read(vec);
 }
 
 
@@ -297,10 +515,7 @@ bool ENG_API Eng::Serializer::deserialize(glm::vec4 &vec)
  */
 bool ENG_API Eng::Serializer::deserialize(glm::mat4 &mat)
 {
-   deserialize(&mat, sizeof(glm::mat4));
-
-   // Done:
-   return true;
+   return read(mat);
 }
 
 
@@ -319,16 +534,180 @@ bool ENG_API Eng::Serializer::deserialize(void *rawData, uint64_t nrOfBytes)
       ENG_LOG_ERROR("Invalid params");
       return false;
    }
-   if (reserved->position + nrOfBytes > reserved->nrOfBytes)
+
+   // Increase and store:   
+   const void *src = claim(nrOfBytes);
+   if (src == nullptr)
+      return false;
+   memcpy(rawData, src, nrOfBytes);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Checks that the given number of bytes is available at the current position and moves past them.
+ * @param nrOfBytes number of bytes to read
+ * @return pointer to the bytes, or nullptr if not enough data is left
+ */
+const void ENG_API *Eng::Serializer::claim(uint64_t nrOfBytes)
+{
+   if (nrOfBytes > reserved->nrOfBytes - reserved->position)
    {
       ENG_LOG_ERROR("Buffer overflow");
-      return false;
+      return nullptr;
    }
 
-   // Increase and store:   
-   memcpy(rawData, &reserved->data[reserved->position], nrOfBytes);
+   const void *ptr = reserved->base() + reserved->position;
    reserved->position += nrOfBytes;
 
    // Done:
-   return true;
+   return ptr;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a string, zero-terminated.
+ * @param text string to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(const std::string &text)
+{
+   return writeSpan(text.c_str(), text.size() + 1);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a byte.
+ * @param byte byte to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(uint8_t byte)
+{
+   return write(byte);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a boolean.
+ * @param _bool boolean to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(bool _bool)
+{
+   return write(_bool);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a uint.
+ * @param uint unsigned int to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(uint32_t uint)
+{
+   return write(uint);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a float.
+ * @param _float float to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(float _float)
+{
+   return write(_float);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a vec3.
+ * @param vec vec3 to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(const glm::vec3 &vec)
+{
+   return write(vec);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a vec4.
+ * @param vec vec4 to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(const glm::vec4 &vec)
+{
+   return write(vec);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a mat4.
+ * @param mat mat4 to serialize
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(const glm::mat4 &mat)
+{
+   return write(mat);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Serializes a series of raw bytes.
+ * @param rawData pointer to data
+ * @param nrOfBytes number of bytes
+ * @return TF
+ */
+bool ENG_API Eng::Serializer::serialize(const void *rawData, uint64_t nrOfBytes)
+{
+   // Safety net:
+   if (rawData == nullptr && nrOfBytes)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   return writeSpan(static_cast<const uint8_t *>(rawData), nrOfBytes);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Makes room for the given number of bytes at the current position and moves past them. Data is overwritten when 
+ * the position is not at the end. Memory-mapped data cannot grow.
+ * @param nrOfBytes number of bytes to write
+ * @return pointer where to write the bytes, or nullptr if error
+ */
+void ENG_API *Eng::Serializer::grow(uint64_t nrOfBytes)
+{
+   const uint64_t end = reserved->position + nrOfBytes;
+   if (end > reserved->nrOfBytes)
+   {
+      if (reserved->mapping)
+      {
+         ENG_LOG_ERROR("Memory-mapped data cannot grow");
+         return nullptr;
+      }
+      reserved->data.resize(end);
+      reserved->nrOfBytes = end;
+   }
+
+   void *ptr = reserved->base() + reserved->position;
+   reserved->position = end;
+
+   // Done:
+   return ptr;
 }
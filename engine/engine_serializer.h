@@ -33,10 +33,18 @@ public: //
    void *getData() const;
    void *getDataAtCurPos() const;
    uint64_t getNrOfBytes() const;
+   uint64_t getPosition() const;
+   bool setPosition(uint64_t position);
+   bool isMapped() const;
+
+   // Files:
+   bool map(const std::string &filename);
+   bool save(const std::string &filename) const;
 
    // Serialization:
    void clear();
    void reset();  
+   bool skip(uint64_t nrOfBytes);
    bool deserialize(std::string &text);
    bool deserialize(uint8_t &byte);
    bool deserialize(bool &_bool);
@@ -46,6 +54,22 @@ public: //
    bool deserialize(glm::vec4 &vec);
    bool deserialize(glm::mat4 &mat);
    bool deserialize(void *rawData, uint64_t nrOfBytes);   
+   bool serialize(const std::string &text);
+   bool serialize(uint8_t byte);
+   bool serialize(bool _bool);
+   bool serialize(uint32_t uint);
+   bool serialize(float _float);
+   bool serialize(const glm::vec3 &vec);
+   bool serialize(const glm::vec4 &vec);
+   bool serialize(const glm::mat4 &mat);
+   bool serialize(const void *rawData, uint64_t nrOfBytes);
+
+   // Typed fast path (trivially-copyable types only):
+   template <typename T> bool read(T &value);
+   template <typename T> bool readSpan(T *values, uint64_t count);
+   template <typename T> const T *readSpan(uint64_t count);
+   template <typename T> bool write(const T &value);
+   template <typename T> bool writeSpan(const T *values, uint64_t count);
 
 
 ///////////
@@ -55,6 +79,117 @@ private: //
    // Reserved:
    struct Reserved;
    std::unique_ptr<Reserved> reserved;
+
+   // Typed fast path:
+   const void *claim(uint64_t nrOfBytes);
+   void *grow(uint64_t nrOfBytes);
 };
 
 
+
+//////////////////////
+// TEMPLATE METHODS //
+//////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reads a single value, with one bounds check for the whole record.
+ * @param value value to read
+ * @return TF
+ */
+template <typename T>
+bool Serializer::read(T &value)
+{
+   static_assert(std::is_trivially_copyable<T>::value, "Type must be trivially copyable");
+   const void *src = claim(sizeof(T));
+   if (src == nullptr)
+      return false;
+   std::memcpy(&value, src, sizeof(T));
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reads an array of values, with one bounds check for the whole array.
+ * @param values destination array
+ * @param count number of values to read
+ * @return TF
+ */
+template <typename T>
+bool Serializer::readSpan(T *values, uint64_t count)
+{
+   static_assert(std::is_trivially_copyable<T>::value, "Type must be trivially copyable");
+   const void *src = claim(count * sizeof(T));
+   if (src == nullptr || (count && values == nullptr))
+      return false;
+   std::memcpy(values, src, count * sizeof(T));
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Reads an array of values in place, returning a pointer into the serialized data instead of copying it. The pointer
+ * remains valid as long as the data (or its memory mapping) does. Data is not necessarily aligned to T: use it as raw
+ * memory (e.g., for GPU uploads or memcpy).
+ * @param count number of values to read
+ * @return pointer to the first value, or nullptr if error
+ */
+template <typename T>
+const T *Serializer::readSpan(uint64_t count)
+{
+   static_assert(std::is_trivially_copyable<T>::value, "Type must be trivially copyable");
+   return static_cast<const T *>(claim(count * sizeof(T)));
+}
+
+
+
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Writes a single value at the current position, growing the data if needed.
+ * @param value value to write
+ * @return TF
+ */
+template <typename T>
+bool Serializer::write(const T &value)
+{
+   static_assert(std::is_trivially_copyable<T>::value, "Type must be trivially copyable");
+   void *dst = grow(sizeof(T));
+   if (dst == nullptr)
+      return false;
+   std::memcpy(dst, &value, sizeof(T));
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Writes an array of values at the current position, growing the data if needed.
+ * @param values source array
+ * @param count number of values to write
+ * @return TF
+ */
+template <typename T>
+bool Serializer::writeSpan(const T *values, uint64_t count)
+{
+   static_assert(std::is_trivially_copyable<T>::value, "Type must be trivially copyable");
+   if (count && values == nullptr)
+      return false;
+   void *dst = grow(count * sizeof(T));
+   if (dst == nullptr)
+      return false;
+   if (count)
+      std::memcpy(dst, values, count * sizeof(T));
+
+   // Done:
+   return true;
+}
\ No newline at end of file
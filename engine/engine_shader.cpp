@@ -63,6 +63,7 @@ struct Eng::Shader::Reserved
 ENG_API Eng::Shader::Shader() : reserved(std::make_unique<Eng::Shader::Reserved>())
 {
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -74,6 +75,7 @@ ENG_API Eng::Shader::Shader() : reserved(std::make_unique<Eng::Shader::Reserved>
 ENG_API Eng::Shader::Shader(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Shader::Reserved>())
 {
    ENG_LOG_DETAIL("[+]");
+   typeTags = tags;
 }
 
 
@@ -84,6 +86,7 @@ ENG_API Eng::Shader::Shader(const std::string &name) : Eng::Object(name), reserv
 ENG_API Eng::Shader::Shader(Shader &&other) : Eng::Object(std::move(other)), Eng::Managed(std::move(other)), reserved(std::move(other.reserved))
 {
    ENG_LOG_DETAIL("[M]");
+   typeTags = tags;
 }
 
 
@@ -20,6 +20,9 @@ public: //
    // Special values:
    static Shader empty;
 
+   // Type tags:
+   static constexpr uint32_t tags = Eng::Object::tags | static_cast<uint32_t>(Tag::shader);
+
    // Consts:
    static constexpr uint32_t maxLogSize =  4096;              ///< Max shader compiler log size in bytes
 
@@ -0,0 +1,210 @@
+/**
+ * @file		engine_ssbo.cpp
+ * @brief	OpenGL Shader Storage Buffer Object (SSBO)
+ *
+ * @author	Achille Peternier (achille.peternier@supsi.ch), (C) SUPSI
+ */
+
+
+
+//////////////
+// #INCLUDE //
+//////////////
+
+   // Main include:
+   #include "engine.h"
+
+   // OGL:      
+   #include <GL/glew.h>
+   #include <GLFW/glfw3.h>
+
+
+
+////////////
+// STATIC //
+////////////
+
+   // Special values:
+   Eng::Ssbo Eng::Ssbo::empty("[empty]");
+
+
+
+/////////////////////////
+// RESERVED STRUCTURES //
+/////////////////////////
+
+/**
+ * @brief SSBO reserved structure.
+ */
+struct Eng::Ssbo::Reserved
+{  
+   GLuint oglId;        ///< OpenGL buffer ID
+   uint64_t size;       ///< Size in bytes
+
+
+   /**
+    * Constructor.
+    */
+   Reserved() : oglId{ 0 }, size{ 0 }
+   {}
+};
+
+
+
+////////////////////////
+// BODY OF CLASS Ssbo //
+////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+ENG_API Eng::Ssbo::Ssbo() : reserved(std::make_unique<Eng::Ssbo::Reserved>())
+{
+   ENG_LOG_DETAIL("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor with name.
+ * @param name node name
+ */
+ENG_API Eng::Ssbo::Ssbo(const std::string &name) : Eng::Object(name), reserved(std::make_unique<Eng::Ssbo::Reserved>())
+{
+   ENG_LOG_DETAIL("[+]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Move constructor.
+ */
+ENG_API Eng::Ssbo::Ssbo(Ssbo &&other) : Eng::Object(std::move(other)), Eng::Managed(std::move(other)), reserved(std::move(other.reserved))
+{
+   ENG_LOG_DETAIL("[M]");
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Destructor.
+ */
+ENG_API Eng::Ssbo::~Ssbo()
+{
+   ENG_LOG_DETAIL("[-]");
+   if (reserved)
+      this->free();
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the GLuint object ID.
+ * @return object ID or 0 if not valid
+ */
+uint32_t ENG_API Eng::Ssbo::getOglHandle() const
+{
+   return reserved->oglId;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the size of the storage allocated for this SSBO.
+ * @return size in bytes
+ */
+uint64_t ENG_API Eng::Ssbo::getSize() const
+{
+   return reserved->size;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Initializes an OpenGL SSBO.
+ * @return TF
+ */
+bool ENG_API Eng::Ssbo::init()
+{
+   if (this->Eng::Managed::init() == false)
+      return false;
+
+   // Free buffer if already stored:
+   if (reserved->oglId)   
+   {   
+      glDeleteBuffers(1, &reserved->oglId);    
+      reserved->oglId = 0;   
+      reserved->size = 0;
+   }   
+
+   // Create it:		    
+   glGenBuffers(1, &reserved->oglId);          
+
+   // Done:   
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Releases an OpenGL SSBO.
+ * @return TF
+ */
+bool ENG_API Eng::Ssbo::free()
+{
+   if (this->Eng::Managed::free() == false)
+      return false;
+
+   // Free SSBO if stored:
+   if (reserved->oglId)
+   {
+      glDeleteBuffers(1, &reserved->oglId);
+      reserved->oglId = 0;
+      reserved->size = 0;
+   }
+
+   // Done:   
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Create buffer by allocating the required storage. Meant for data rewritten often (e.g., every frame): calling it 
+ * again orphans the previous storage instead of waiting for the GPU to release it.
+ * @param size size in bytes
+ * @param data pointer to the data to copy into the buffer
+ * @return TF
+ */
+bool ENG_API Eng::Ssbo::create(uint64_t size, const void *data)
+{	
+   // Init buffer:
+   if (!this->isInitialized())
+      this->init();
+
+   // Fill it:		              
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, reserved->oglId);
+   glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(size), data, GL_DYNAMIC_DRAW); 
+   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+   // Done:
+   reserved->size = size;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Rendering method. Binds the buffer to the given shader storage binding point.
+ * @param value binding point
+ * @param data generic pointer to any kind of data
+ * @return TF
+ */
+bool ENG_API Eng::Ssbo::render(uint32_t value, void *data) const
+{	   
+   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, value, reserved->oglId);  
+   
+   // Done:
+   return true;
+}
@@ -36,7 +36,7 @@ Eng::Texture Eng::Texture::empty("[empty]");
 /**
  * @brief Texture reserved structure.
  */
-struct Eng::Texture::Reserved
+struct Eng::Texture::Reserved : Eng::Pooled<Eng::Texture::Reserved>
 {
     std::reference_wrapper<const Eng::Bitmap> bitmap;
     Eng::Texture::Format format;
@@ -67,6 +67,7 @@ struct Eng::Texture::Reserved
 ENG_API Eng::Texture::Texture() : reserved(std::make_unique<Eng::Texture::Reserved>())
 {
     ENG_LOG_DETAIL("[+]");
+    typeTags = tags;
 }
 
 
@@ -78,6 +79,7 @@ ENG_API Eng::Texture::Texture() : reserved(std::make_unique<Eng::Texture::Reserv
 ENG_API Eng::Texture::Texture(const Eng::Bitmap& bitmap) : reserved(std::make_unique<Eng::Texture::Reserved>())
 {
     ENG_LOG_DETAIL("[+]");
+    typeTags = tags;
     load(bitmap);
 }
 
@@ -90,6 +92,7 @@ ENG_API Eng::Texture::Texture(const Eng::Bitmap& bitmap) : reserved(std::make_un
 ENG_API Eng::Texture::Texture(const std::string& name) : Eng::Object(name), reserved(std::make_unique<Eng::Texture::Reserved>())
 {
     ENG_LOG_DETAIL("[+]");
+    typeTags = tags;
 }
 
 
@@ -100,6 +103,7 @@ ENG_API Eng::Texture::Texture(const std::string& name) : Eng::Object(name), rese
 ENG_API Eng::Texture::Texture(Texture&& other) : Eng::Object(std::move(other)), Eng::Managed(std::move(other)), reserved(std::move(other.reserved))
 {
     ENG_LOG_DETAIL("[M]");
+    typeTags = tags;
 }
 
 
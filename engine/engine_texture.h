@@ -20,6 +20,9 @@ public: //
        // Special values:
     static Texture empty;
 
+    // Type tags:
+    static constexpr uint32_t tags = Eng::Object::tags | static_cast<uint32_t>(Tag::texture);
+
 
     /**
      * @brief Types of texture.
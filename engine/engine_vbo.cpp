@@ -14,6 +14,10 @@
    // Main include:
    #include "engine.h"
 
+   // C/C++:
+   #include <cstddef>
+   #include <limits>
+
    // OGL:      
    #include <GL/glew.h>
    #include <GLFW/glfw3.h>
@@ -27,6 +31,73 @@
    // Special values:
    Eng::Vbo Eng::Vbo::empty("[empty]");
 
+   // Layout check:
+   static_assert(sizeof(Eng::Vbo::VertexData) == 24, "Invalid VertexData size");
+   static_assert(sizeof(Eng::Vbo::CompactVertexData) == 16, "Invalid CompactVertexData size");
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Encodes a unit vector into octahedral coordinates.
+ * @param v vector to encode
+ * @return coordinates in the range [-1, 1]
+ */
+static glm::vec2 octEncode(const glm::vec3 &v)
+{
+   const float sum = glm::abs(v.x) + glm::abs(v.y) + glm::abs(v.z);
+   if (sum == 0.0f)
+      return glm::vec2(0.0f);
+
+   const glm::vec2 p = glm::vec2(v) / sum;
+   if (v.z >= 0.0f)
+      return p;
+   return (1.0f - glm::abs(glm::vec2(p.y, p.x))) * glm::vec2(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Decodes octahedral coordinates into a unit vector (same as the shader version).
+ * @param e coordinates in the range [-1, 1]
+ * @return unit vector
+ */
+static glm::vec3 octDecode(const glm::vec2 &e)
+{
+   glm::vec3 v(e, 1.0f - glm::abs(e.x) - glm::abs(e.y));
+   if (v.z < 0.0f)
+      v = glm::vec3((1.0f - glm::abs(glm::vec2(v.y, v.x))) * glm::vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f), v.z);
+   return glm::normalize(v);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Encodes a tangent and its handedness as 2x snorm8: octahedral coordinates, the second one remapped to [1, 127] and 
+ * signed with the handedness (same as the shader version).
+ * @param t tangent, handedness in w
+ * @return packed tangent
+ */
+static uint16_t tangentEncode(const glm::vec4 &t)
+{
+   const glm::vec2 e = octEncode(glm::vec3(t));
+   const float q = 1.0f + glm::round((glm::clamp(e.y, -1.0f, 1.0f) + 1.0f) * 63.0f);
+   return glm::packSnorm2x8(glm::vec2(e.x, (t.w < 0.0f ? -q : q) / 127.0f));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Decodes a tangent packed by tangentEncode() (same as the shader version).
+ * @param packed packed tangent
+ * @return tangent, handedness (-1 or 1) in w
+ */
+static glm::vec4 tangentDecode(uint16_t packed)
+{
+   const glm::vec2 s = glm::unpackSnorm2x8(packed);
+   const float y = (glm::abs(s.y) * 127.0f - 1.0f) / 63.0f - 1.0f;
+   return glm::vec4(octDecode(glm::vec2(s.x, y)), s.y < 0.0f ? -1.0f : 1.0f);
+}
+
 
 
 /////////////////////////
@@ -40,12 +111,15 @@ struct Eng::Vbo::Reserved
 {  
    GLuint oglId;           ///< OpenGL shader ID
    uint32_t nrOfVertices;  ///< Nr. of vertices
+   Format format;          ///< Vertex layout
+   glm::vec3 scale;        ///< Position dequantization scale (compact layout)
+   glm::vec3 bias;         ///< Position dequantization bias (compact layout)
 
 
    /**
     * Constructor.
     */
-   Reserved() : oglId{ 0 }, nrOfVertices{ 0 }
+   Reserved() : oglId{ 0 }, nrOfVertices{ 0 }, format{ Format::standard }, scale{ 1.0f }, bias{ 0.0f }
    {}
 };
 
@@ -120,6 +194,39 @@ uint32_t ENG_API Eng::Vbo::getNrOfVertices() const
 }
 
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the vertex layout used by this VBO.
+ * @return vertex layout
+ */
+Eng::Vbo::Format ENG_API Eng::Vbo::getFormat() const
+{
+   return reserved->format;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the scale to apply to the normalized positions of the compact layout (size of the bounding box).
+ * @return scale, (1, 1, 1) for the standard layout
+ */
+const glm::vec3 ENG_API &Eng::Vbo::getPositionScale() const
+{
+   return reserved->scale;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Return the bias to add to the scaled positions of the compact layout (minimum of the bounding box).
+ * @return bias, (0, 0, 0) for the standard layout
+ */
+const glm::vec3 ENG_API &Eng::Vbo::getPositionBias() const
+{
+   return reserved->bias;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  * Initializes an OpenGL VBO.
@@ -170,15 +277,34 @@ bool ENG_API Eng::Vbo::free()
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
- * Create buffer by allocating the required storage.
+ * Create buffer by allocating the required storage. Vertices are always given as VertexData and quantized on the fly 
+ * when the compact layout is requested.
  * @param nfOfVertices number of vertices to store
  * @param data pointer to the data to copy into the buffer 
+ * @param format vertex layout to use on the GPU
  * @return TF
  */
-bool ENG_API Eng::Vbo::create(uint32_t nrOfVertices, const void *data)
+bool ENG_API Eng::Vbo::create(uint32_t nrOfVertices, const void *data, Format format)
 {	
+   // Safety net:
+   if (format == Format::last)
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Quantize, if needed:
+   glm::vec3 scale(1.0f), bias(0.0f);
+   std::vector<CompactVertexData> compact;
+   if (format == Format::compact && data)
+   {
+      compact.resize(nrOfVertices);
+      quantize(nrOfVertices, data, compact.data(), scale, bias);
+      data = compact.data();
+   }
+
    // Unit size:
-   const uint32_t unitSize = sizeof(VertexData);
+   const uint32_t unitSize = (format == Format::compact) ? sizeof(CompactVertexData) : sizeof(VertexData);
 
    // Init buffer:
    if (!this->isInitialized())
@@ -193,34 +319,199 @@ bool ENG_API Eng::Vbo::create(uint32_t nrOfVertices, const void *data)
 
    // Setup interleaved-buffer:
    glBindVertexBuffer(0, oglId, 0, static_cast<GLsizei>(unitSize));   
-   uint32_t offset = 0;   
+   setAttribFormat(format);
+
+   // Done:
+   reserved->nrOfVertices = nrOfVertices;
+   reserved->format = format;
+   reserved->scale = scale;
+   reserved->bias = bias;
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Copies the content of the buffer back into system memory, as VertexData (compact buffers are dequantized). The 
+ * destination must hold getNrOfVertices() vertices.
+ * @param data pointer to the destination memory
+ * @return TF
+ */
+bool ENG_API Eng::Vbo::download(void *data) const
+{
+   // Safety net:
+   if (data == nullptr || !this->isInitialized())
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Copy-read target, to leave the current bindings untouched:
+   glBindBuffer(GL_COPY_READ_BUFFER, reserved->oglId);
+   if (reserved->format == Format::standard)
+      glGetBufferSubData(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(reserved->nrOfVertices) * sizeof(VertexData), data);
+   else
+   {
+      // Back to the standard layout:
+      std::vector<CompactVertexData> compact(reserved->nrOfVertices);
+      glGetBufferSubData(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(compact.size()) * sizeof(CompactVertexData), compact.data());
+
+      dequantize(reserved->nrOfVertices, compact.data(), reserved->scale, reserved->bias, static_cast<VertexData *>(data));
+   }
+   glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Converts vertices to the compact layout. Positions are quantized within their bounding box, returned as scale and
+ * bias for the dequantization.
+ * @param nrOfVertices number of vertices
+ * @param vertices source vertices (VertexData, not necessarily aligned: e.g., read in place from a file mapping)
+ * @param compact destination, holding nrOfVertices vertices
+ * @param scale position dequantization scale
+ * @param bias position dequantization bias
+ * @return TF
+ */
+bool ENG_API Eng::Vbo::quantize(uint32_t nrOfVertices, const void *vertices, CompactVertexData *compact, glm::vec3 &scale, glm::vec3 &bias)
+{
+   // Safety net:
+   if (nrOfVertices && (vertices == nullptr || compact == nullptr))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Bounding box:
+   scale = glm::vec3(1.0f);
+   bias = glm::vec3(0.0f);
+   const uint8_t *src = static_cast<const uint8_t *>(vertices);
+   glm::vec3 bboxMin(std::numeric_limits<float>::max()), bboxMax(-std::numeric_limits<float>::max());
+   for (uint32_t c = 0; c < nrOfVertices; c++)
+   {
+      glm::vec3 position;
+      std::memcpy(&position, src + c * sizeof(VertexData) + offsetof(VertexData, vertex), sizeof(glm::vec3));
+      bboxMin = glm::min(bboxMin, position);
+      bboxMax = glm::max(bboxMax, position);
+   }
+   if (nrOfVertices)
+   {
+      bias = bboxMin;
+      scale = bboxMax - bboxMin;
+   }
+   const glm::vec3 invScale = glm::vec3(65535.0f) / glm::max(scale, glm::vec3(std::numeric_limits<float>::min()));
+
+   for (uint32_t c = 0; c < nrOfVertices; c++)
+   {
+      VertexData vertex;
+      std::memcpy(&vertex, src + c * sizeof(VertexData), sizeof(VertexData));
+      const glm::vec3 q = glm::round(glm::clamp((vertex.vertex - bias) * invScale, 0.0f, 65535.0f));
+      compact[c].vertex[0] = static_cast<uint16_t>(q.x);
+      compact[c].vertex[1] = static_cast<uint16_t>(q.y);
+      compact[c].vertex[2] = static_cast<uint16_t>(q.z);
+      compact[c].normal = glm::packSnorm2x16(octEncode(glm::vec3(glm::unpackSnorm3x10_1x2(vertex.normal))));
+      compact[c].uv = vertex.uv;
+      compact[c].tangent = tangentEncode(glm::unpackSnorm3x10_1x2(vertex.tangent));
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Converts compact vertices back to the standard layout.
+ * @param nrOfVertices number of vertices
+ * @param compact source vertices
+ * @param scale position dequantization scale
+ * @param bias position dequantization bias
+ * @param vertices destination, holding nrOfVertices vertices
+ * @return TF
+ */
+bool ENG_API Eng::Vbo::dequantize(uint32_t nrOfVertices, const CompactVertexData *compact, const glm::vec3 &scale, const glm::vec3 &bias, VertexData *vertices)
+{
+   // Safety net:
+   if (nrOfVertices && (vertices == nullptr || compact == nullptr))
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   for (uint32_t c = 0; c < nrOfVertices; c++)
+   {
+      const glm::vec3 q(compact[c].vertex[0], compact[c].vertex[1], compact[c].vertex[2]);
+      vertices[c].vertex = bias + q / 65535.0f * scale;
+      vertices[c].normal = glm::packSnorm3x10_1x2(glm::vec4(octDecode(glm::unpackSnorm2x16(compact[c].normal)), 0.0f));
+      vertices[c].uv = compact[c].uv;
+      vertices[c].tangent = glm::packSnorm3x10_1x2(tangentDecode(compact[c].tangent));
+   }
+
+   // Done:
+   return true;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Describes the given vertex layout to the currently bound VAO. All the attributes are sourced from binding point 0,
+ * the buffer itself is attached by the caller through glBindVertexBuffer().
+ * @param format vertex layout
+ * @return TF
+ */
+bool ENG_API Eng::Vbo::setAttribFormat(Format format)
+{
+   if (format == Format::compact)
+   {
+      // Vertex position data (dequantized in the vertex shader):
+      glVertexAttribFormat(static_cast<GLuint>(Attrib::vertex), 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(CompactVertexData, vertex));
+
+      // Normal data (octahedral):
+      glVertexAttribFormat(static_cast<GLuint>(Attrib::normal), 2, GL_SHORT, GL_TRUE, offsetof(CompactVertexData, normal));
+
+      // Texture coordinates:
+      glVertexAttribFormat(static_cast<GLuint>(Attrib::texcoord), 2, GL_HALF_FLOAT, GL_FALSE, offsetof(CompactVertexData, uv));
+
+      // Tangent data (octahedral):
+      glVertexAttribFormat(static_cast<GLuint>(Attrib::tangent), 2, GL_BYTE, GL_TRUE, offsetof(CompactVertexData, tangent));
+   }
+   else if (format == Format::standard)
+   {
+      uint32_t offset = 0;   
    
-   // Vertex position data:
-   glVertexAttribFormat(static_cast<GLuint>(Attrib::vertex), 3, GL_FLOAT, GL_FALSE, offset);
-   glVertexAttribBinding(static_cast<GLuint>(Attrib::vertex), 0);
-   glEnableVertexAttribArray(static_cast<GLuint>(Attrib::vertex));
-   offset += sizeof(glm::vec3);
+      // Vertex position data:
+      glVertexAttribFormat(static_cast<GLuint>(Attrib::vertex), 3, GL_FLOAT, GL_FALSE, offset);
+      offset += sizeof(glm::vec3);
    
-   // Normal data:   
-   glVertexAttribFormat(static_cast<GLuint>(Attrib::normal), 4, GL_INT_2_10_10_10_REV, GL_TRUE, offset);
-   glVertexAttribBinding(static_cast<GLuint>(Attrib::normal), 0);
-   glEnableVertexAttribArray(static_cast<GLuint>(Attrib::normal));
-   offset += sizeof(uint32_t); // 1x compressed vector  
-
-   // Texture coordinates:
-   glVertexAttribFormat(static_cast<GLuint>(Attrib::texcoord), 2, GL_HALF_FLOAT, GL_FALSE, offset);
-   glVertexAttribBinding(static_cast<GLuint>(Attrib::texcoord), 0);
-   glEnableVertexAttribArray(static_cast<GLuint>(Attrib::texcoord));
-   offset += sizeof(float); // 2x half float
+      // Normal data:   
+      glVertexAttribFormat(static_cast<GLuint>(Attrib::normal), 4, GL_INT_2_10_10_10_REV, GL_TRUE, offset);
+      offset += sizeof(uint32_t); // 1x compressed vector  
+
+      // Texture coordinates:
+      glVertexAttribFormat(static_cast<GLuint>(Attrib::texcoord), 2, GL_HALF_FLOAT, GL_FALSE, offset);
+      offset += sizeof(float); // 2x half float
    
-   // Tangent data:
-   glVertexAttribFormat(static_cast<GLuint>(Attrib::tangent), 4, GL_INT_2_10_10_10_REV, GL_TRUE, offset);
-   glVertexAttribBinding(static_cast<GLuint>(Attrib::tangent), 0);
-   glEnableVertexAttribArray(static_cast<GLuint>(Attrib::tangent));
-   offset += sizeof(uint32_t); // 1x compressed vector
+      // Tangent data:
+      glVertexAttribFormat(static_cast<GLuint>(Attrib::tangent), 4, GL_INT_2_10_10_10_REV, GL_TRUE, offset);
+      offset += sizeof(uint32_t); // 1x compressed vector
+   }
+   else
+   {
+      ENG_LOG_ERROR("Invalid params");
+      return false;
+   }
+
+   // Bind and enable all the attributes:
+   for (uint32_t c = 0; c < static_cast<uint32_t>(Attrib::last); c++)
+   {
+      glVertexAttribBinding(c, 0);
+      glEnableVertexAttribArray(c);
+   }
 
    // Done:
-   reserved->nrOfVertices = nrOfVertices;
    return true;
 }
 
@@ -36,6 +36,19 @@ public: //
    };
 
    
+   /**
+    * @brief Vertex layouts available on the GPU.
+    */
+   enum class Format : uint32_t
+   {
+      standard,      ///< VertexData, as stored in OVO files (24 bytes)
+      compact,       ///< CompactVertexData, quantized (16 bytes)
+
+      // Terminator:
+      last
+   };
+
+
    /**
     * @brief Per-vertex data
     */
@@ -55,6 +68,27 @@ public: //
 	};
 
 
+   /**
+    * @brief Per-vertex data, compact layout. Positions are relative to the bounding box of the buffer (see 
+    *        getPositionScale() and getPositionBias()), normals and tangents are octahedral-encoded. The tangent 
+    *        handedness (w) is stored as the sign of its second component, whose magnitude is remapped to [1, 127].
+    */
+   struct CompactVertexData
+   {
+      uint16_t vertex[3];  ///< Position, 3x unorm16 within the bounding box
+      uint16_t tangent;    ///< Tangent, octahedral with handedness, packed as 2x snorm8
+      uint32_t uv;         ///< Tex coords, packed as 2xfp16
+      uint32_t normal;     ///< Normal, octahedral, packed as 2x snorm16
+
+
+      /**
+       * Constructor.
+       */
+      inline CompactVertexData() noexcept : vertex{ 0, 0, 0 }, tangent{ 0 }, uv{ 0 }, normal{ 0 }
+      {}
+   };
+
+
    // Const/dest:
    Vbo();
    Vbo(Vbo &&other);
@@ -64,9 +98,18 @@ public: //
    // Get/set:   
    uint32_t getNrOfVertices() const;
    uint32_t getOglHandle() const;
+   Format getFormat() const;
+   const glm::vec3 &getPositionScale() const;
+   const glm::vec3 &getPositionBias() const;
 
    // Data:
-   bool create(uint32_t nrOfVertices, const void *data = nullptr);
+   bool create(uint32_t nrOfVertices, const void *data = nullptr, Format format = Format::standard);
+   bool download(void *data) const;
+
+   // Layout conversion:
+   static bool quantize(uint32_t nrOfVertices, const void *vertices, CompactVertexData *compact, glm::vec3 &scale, glm::vec3 &bias);
+   static bool dequantize(uint32_t nrOfVertices, const CompactVertexData *compact, const glm::vec3 &scale, const glm::vec3 &bias, VertexData *vertices);
+   static bool setAttribFormat(Format format);
 
    // Rendering methods:   
    bool render(uint32_t value = 0, void *data = nullptr) const;